@@ -0,0 +1,158 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <breakout/clock.h>
+#include <breakout/game.h>
+#include <breakout/game_instance.h>
+#include <breakout/headless.h>
+#include <breakout/task_scheduler.h>
+
+#define DEFAULT_BATCH_GAMES 256
+
+typedef struct BatchArguments {
+    const char *configuration_path;
+    long        games;
+    long        max_ticks;
+    long        threads;
+    uint32_t    seed;
+} BatchArguments;
+
+typedef struct BatchJob {
+    const Configuration *config;
+    long                 max_ticks;
+    uint32_t             seed;
+    GameState           *results;
+} BatchJob;
+
+void PrintUsage(const char *program) {
+    printf("Usage: %s [options] [path_to_config.toml]\n", program);
+    printf("Options:\n");
+    printf("  --games <n>     number of independent games\n");
+    printf("  --ticks <n>     tick limit of a single game\n");
+    printf("  --threads <n>   threads to shard the games across\n");
+    printf("  --seed <n>      seed of the first game, game i uses seed + i\n");
+}
+
+bool ParseArguments(int argc, char **argv, BatchArguments *arguments) {
+    for (int i = 1; i < argc; i++) {
+        const char *argument = argv[i];
+        bool        has_value = i + 1 < argc;
+
+        if (strcmp(argument, "--games") == 0 && has_value) {
+            arguments->games = atol(argv[++i]);
+        } else if (strcmp(argument, "--ticks") == 0 && has_value) {
+            arguments->max_ticks = atol(argv[++i]);
+        } else if (strcmp(argument, "--threads") == 0 && has_value) {
+            arguments->threads = atol(argv[++i]);
+        } else if (strcmp(argument, "--seed") == 0 && has_value) {
+            arguments->seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strncmp(argument, "--", 2) == 0) {
+            fprintf(stderr, "Unknown or incomplete option \"%s\"\n", argument);
+            return false;
+        } else {
+            arguments->configuration_path = argument;
+        }
+    }
+
+    if (arguments->games < 1 || arguments->max_ticks < 1) {
+        fprintf(stderr, "Games and ticks must be positive\n");
+        return false;
+    }
+
+    if (arguments->threads < 1
+        || arguments->threads > TASK_SCHEDULER_MAX_WORKERS) {
+        fprintf(
+            stderr,
+            "Threads must be between 1 and %d\n",
+            TASK_SCHEDULER_MAX_WORKERS
+        );
+        return false;
+    }
+
+    return true;
+}
+
+void PlayGames(int start_index, int end_index, uint32_t worker, void *context) {
+    (void)worker;
+
+    BatchJob *job = context;
+
+    for (int i = start_index; i < end_index; i++) {
+        // NOTE: seed 0 means the configured velocity, keep it out of the range
+        uint32_t seed = job->seed + (uint32_t)i;
+
+        GameInstance *instance =
+            CreateGameInstance(job->config, seed != 0 ? seed : 1);
+        StepGameInstance(instance, job->max_ticks, AutopilotInput, NULL);
+        job->results[i] = GetGameState(instance);
+        DestroyGameInstance(instance);
+    }
+}
+
+int main(int argc, char **argv) {
+    BatchArguments arguments = {
+        .games = DEFAULT_BATCH_GAMES,
+        .max_ticks = HEADLESS_DEFAULT_TICKS,
+        .threads = 1,
+        .seed = 1,
+    };
+
+    if (!ParseArguments(argc, argv, &arguments)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    InstallAllocators();
+
+    Configuration config = DefaultConfiguration();
+
+    if (arguments.configuration_path) {
+        ProcessConfiguration(arguments.configuration_path, &config);
+    }
+
+    BatchJob job = {
+        .config = &config,
+        .max_ticks = arguments.max_ticks,
+        .seed = arguments.seed,
+        .results =
+            MemoryCalloc(MEMORY_GAME, arguments.games, sizeof(GameState)),
+    };
+
+    TaskScheduler *scheduler = CreateTaskScheduler(arguments.threads);
+
+    double start = GetClockSeconds();
+    // NOTE: the games are cut into four ranges of consecutive games per
+    // thread, they differ in length so idle threads steal the ranges left
+    RunParallel(scheduler, PlayGames, arguments.games, 1, &job);
+    double seconds = GetClockSeconds() - start;
+
+    DestroyTaskScheduler(scheduler);
+
+    long ticks = 0;
+    long score = 0;
+    long balls_lost = 0;
+    long cleared = 0;
+
+    for (long i = 0; i < arguments.games; i++) {
+        ticks += job.results[i].tick;
+        score += job.results[i].score;
+        balls_lost += job.results[i].balls_lost;
+        cleared += job.results[i].cleared ? 1 : 0;
+    }
+
+    printf("Threads:          %ld\n", arguments.threads);
+    printf("Games:            %ld\n", arguments.games);
+    printf("Cleared:          %ld\n", cleared);
+    printf("Avg score:        %.2f\n", (double)score / arguments.games);
+    printf("Avg balls lost:   %.2f\n", (double)balls_lost / arguments.games);
+    printf("Ticks:            %ld\n", ticks);
+    printf("Elapsed:          %.3f s\n", seconds);
+    printf("Ticks/sec:        %.0f\n", seconds > 0.0 ? ticks / seconds : 0.0);
+    printf(
+        "Games/min:        %.0f\n",
+        seconds > 0.0 ? arguments.games * 60.0 / seconds : 0.0
+    );
+
+    MemoryFree(job.results);
+    return 0;
+}
@@ -0,0 +1,642 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <box2d/box2d.h>
+#include <breakout/clock.h>
+#include <breakout/game.h>
+#include <breakout/headless.h>
+#include <breakout/level.h>
+#include <breakout/rollback.h>
+#include <breakout/task_scheduler.h>
+
+#define BENCH_MIN_SECONDS   0.25
+#define BENCH_MAX_OPS       100000
+#define BENCH_SESSION_TICKS 600
+
+// NOTE: Box2D steps are timed single threaded and with this many workers
+#define BENCH_DEFAULT_WORKERS 4
+
+// NOTE: ten minutes of play, fast enough to recycle every row many times
+#define BENCH_ENDLESS_TICKS        72000
+#define BENCH_ENDLESS_SCROLL_SPEED 400.0
+
+#define BENCH_CONFIGURATION_PATH "breakout_bench.toml"
+#define BENCH_LEVEL_PATH         "breakout_bench.bklv"
+
+// NOTE: rows are fixed at ROWS_NUMBER, so counts are multiples of it
+static const int brick_counts[] = { 64, 512, 4096, 32768, 102400 };
+
+#define BRICK_COUNTS_LENGTH (sizeof(brick_counts) / sizeof(brick_counts[0]))
+
+static const int ball_counts[] = { 1024, 16384, 131072 };
+
+#define BALL_COUNTS_LENGTH (sizeof(ball_counts) / sizeof(ball_counts[0]))
+
+static const int rollback_depths[] = { 1, 2, 4, 8, 16, ROLLBACK_MAX_DEPTH };
+
+#define ROLLBACK_DEPTHS_LENGTH \
+    (sizeof(rollback_depths) / sizeof(rollback_depths[0]))
+
+// NOTE: the budget a rollback has to fit in, next to drawing the frame
+#define BENCH_FRAME_MILLISECONDS (1000.0 / 60.0)
+
+typedef struct BenchArguments {
+    const char *configuration_path;
+    long        max_bricks;
+    long        max_balls;
+    long        worker_count;
+} BenchArguments;
+
+typedef struct BenchResult {
+    double nanoseconds;
+    long   allocations;
+    long   ops;
+    // NOTE: bodies in the world after the measured call, 0 when not relevant
+    int    bodies;
+    // NOTE: swarm balls moved by every op, 0 when not relevant
+    int    balls;
+} BenchResult;
+
+void PrintUsage(const char *program) {
+    printf("Usage: %s [options] [path_to_config.toml]\n", program);
+    printf("Options:\n");
+    printf("  --max-bricks <n>  skip brick counts above n\n");
+    printf("  --max-balls <n>   skip swarm ball counts above n\n");
+    printf("  --workers <n>     threads for the second Box2D step run, 4\n");
+    printf("The configuration is what ProcessConfiguration parses, a generated\n");
+    printf("one is used when none is given.\n");
+}
+
+bool ParseArguments(int argc, char **argv, BenchArguments *arguments) {
+    for (int i = 1; i < argc; i++) {
+        const char *argument = argv[i];
+        bool        has_value = i + 1 < argc;
+
+        if (strcmp(argument, "--max-bricks") == 0 && has_value) {
+            arguments->max_bricks = atol(argv[++i]);
+        } else if (strcmp(argument, "--max-balls") == 0 && has_value) {
+            arguments->max_balls = atol(argv[++i]);
+        } else if (strcmp(argument, "--workers") == 0 && has_value) {
+            arguments->worker_count = atol(argv[++i]);
+            if (arguments->worker_count < 2
+                || arguments->worker_count > TASK_SCHEDULER_MAX_WORKERS) {
+                fprintf(
+                    stderr,
+                    "Worker count must be between 2 and %d\n",
+                    TASK_SCHEDULER_MAX_WORKERS
+                );
+                return false;
+            }
+        } else if (strncmp(argument, "--", 2) == 0) {
+            fprintf(stderr, "Unknown or incomplete option \"%s\"\n", argument);
+            return false;
+        } else {
+            arguments->configuration_path = argument;
+        }
+    }
+
+    return true;
+}
+
+void PrintResult(const char *name, int bricks, const BenchResult *result) {
+    char bricks_column[16] = "-";
+    char bodies_column[16] = "-";
+    char balls_column[16] = "-";
+
+    if (bricks > 0) {
+        snprintf(bricks_column, sizeof(bricks_column), "%d", bricks);
+    }
+
+    if (result->bodies > 0) {
+        snprintf(bodies_column, sizeof(bodies_column), "%d", result->bodies);
+    }
+
+    if (result->balls > 0 && result->nanoseconds > 0) {
+        snprintf(
+            balls_column,
+            sizeof(balls_column),
+            "%.0f",
+            (double)result->balls * result->ops / (result->nanoseconds / 1e6)
+        );
+    }
+
+    printf(
+        "%-24s %8s %14.0f %12.2f %10ld %8s %10s\n",
+        name,
+        bricks_column,
+        result->ops > 0 ? result->nanoseconds / result->ops : 0.0,
+        result->ops > 0 ? (double)result->allocations / result->ops : 0.0,
+        result->ops,
+        bodies_column,
+        balls_column
+    );
+}
+
+/* World and brick store are set up outside of the measurement */
+BenchResult BenchCreateBricks(const Configuration *base, int bricks) {
+    BenchResult result = { 0 };
+
+    while (result.nanoseconds < BENCH_MIN_SECONDS * 1e9
+           && result.ops < BENCH_MAX_OPS) {
+        Configuration config;
+        memcpy(&config, base, sizeof(Configuration));
+        config.bricks_in_row = bricks / ROWS_NUMBER;
+
+        b2WorldDef world_def = b2DefaultWorldDef();
+        world_def.gravity = b2Vec2_zero;
+        config.world_id = b2CreateWorld(&world_def);
+        InitArena(&config.level_arena, ARENA_DEFAULT_BLOCK_SIZE);
+        CreateBrickStore(
+            &config.bricks,
+            bricks,
+            BRICK_STORE_CHUNK_SIZE,
+            &config.level_arena
+        );
+
+        long     allocations = GetTotalAllocationCount();
+        uint64_t start = GetClockNanoseconds();
+
+        CreateBricks(&config);
+
+        result.nanoseconds += GetClockNanoseconds() - start;
+        result.allocations += GetTotalAllocationCount() - allocations;
+        result.ops++;
+        result.bodies = b2World_GetCounters(config.world_id).bodyCount;
+
+        ShutdownGame(&config);
+    }
+
+    return result;
+}
+
+/* Maps a compiled level and decodes every brick into a brick store, the part
+ * of loading a level that does not depend on Box2D */
+BenchResult BenchLoadLevel(int bricks) {
+    BenchResult result = { 0 };
+    LevelBrick *level_bricks =
+        MemoryAlloc(MEMORY_LEVEL, sizeof(LevelBrick) * bricks);
+    int         columns = bricks / ROWS_NUMBER;
+
+    for (int i = 0; i < bricks; i++) {
+        level_bricks[i] = (LevelBrick){
+            .position = { (float)(i % columns), (float)(i / columns) },
+            .size = { 1.f, 1.f },
+            .color = WHITE,
+            .hit_points = 1,
+        };
+    }
+
+    bool written = WriteLevel(BENCH_LEVEL_PATH, level_bricks, bricks);
+    MemoryFree(level_bricks);
+
+    if (!written) {
+        return result;
+    }
+
+    Arena      arena;
+    BrickStore store;
+    InitArena(&arena, ARENA_DEFAULT_BLOCK_SIZE);
+    CreateBrickStore(&store, bricks, BRICK_STORE_CHUNK_SIZE, &arena);
+
+    while (result.nanoseconds < BENCH_MIN_SECONDS * 1e9
+           && result.ops < BENCH_MAX_OPS) {
+        LevelFile level;
+        long      allocations = GetTotalAllocationCount();
+        uint64_t  start = GetClockNanoseconds();
+
+        if (!OpenLevel(&level, BENCH_LEVEL_PATH)) {
+            break;
+        }
+
+        for (int i = 0; i < level.brick_count; i++) {
+            LevelBrick brick = GetLevelBrick(&level, i);
+
+            store.positions[i] = brick.position;
+            store.sizes[i] = brick.size;
+            store.colors[i] = brick.color;
+            store.hit_points[i] = brick.hit_points;
+        }
+
+        CloseLevel(&level);
+
+        result.nanoseconds += GetClockNanoseconds() - start;
+        result.allocations += GetTotalAllocationCount() - allocations;
+        result.ops++;
+    }
+
+    FreeArena(&arena);
+    remove(BENCH_LEVEL_PATH);
+    return result;
+}
+
+/* Same order as TickGame, timing the step of physics and the collision pass
+ * apart */
+void BenchTicks(
+    const Configuration  *base,
+    const PhysicsBackend *physics,
+    int                   bricks,
+    BenchResult          *step,
+    BenchResult          *collisions
+) {
+    *step = (BenchResult){ 0 };
+    *collisions = (BenchResult){ 0 };
+
+    while (step->nanoseconds + collisions->nanoseconds < BENCH_MIN_SECONDS * 1e9
+           && step->ops < BENCH_MAX_OPS) {
+        Configuration config;
+        memcpy(&config, base, sizeof(Configuration));
+        config.bricks_in_row = bricks / ROWS_NUMBER;
+        config.physics = physics;
+
+        InitGame(&config);
+
+        for (long tick = 0; tick < BENCH_SESSION_TICKS; tick++) {
+            GameInput input = AutopilotInput(&config, tick, NULL);
+            ProcessInput(&config, &input);
+
+            long     allocations = GetTotalAllocationCount();
+            uint64_t start = GetClockNanoseconds();
+
+            physics->step(&config, 1.0 / config.tick_rate);
+
+            uint64_t stepped = GetClockNanoseconds();
+            long     step_allocations = GetTotalAllocationCount();
+
+            CheckBallBrickCollisions(&config);
+
+            uint64_t checked = GetClockNanoseconds();
+
+            step->nanoseconds += stepped - start;
+            step->allocations += step_allocations - allocations;
+            step->ops++;
+            collisions->nanoseconds += checked - stepped;
+            collisions->allocations +=
+                GetTotalAllocationCount() - step_allocations;
+            collisions->ops++;
+
+            ClampPlayerMovement(&config);
+            ClampBallMovement(&config);
+
+            b2Vec2 bp = GetBallPosition(&config);
+
+            if (bp.y >= PIXELS_TO_WORLD(HEIGHT)) {
+                ResetBall(&config);
+            }
+        }
+
+        ShutdownGame(&config);
+    }
+}
+
+/* One TickBallSwarm per op over the default brick field, the balls start
+ * spread out over the field so every kernel has work */
+BenchResult BenchBallSwarm(const Configuration *base, int balls) {
+    BenchResult   result = { .balls = balls };
+    Configuration config;
+    memcpy(&config, base, sizeof(Configuration));
+    config.ball_count = balls;
+
+    InitGame(&config);
+
+    BallSwarm *swarm = &config.swarm;
+
+    for (int i = 0; i < swarm->count; i++) {
+        swarm->position_x[i] = (float)(i * 37 % WIDTH);
+        swarm->position_y[i] = (float)(i * 91 % HEIGHT);
+    }
+
+    while (result.nanoseconds < BENCH_MIN_SECONDS * 1e9
+           && result.ops < BENCH_MAX_OPS) {
+        long     allocations = GetTotalAllocationCount();
+        uint64_t start = GetClockNanoseconds();
+
+        TickBallSwarm(&config);
+
+        result.nanoseconds += GetClockNanoseconds() - start;
+        result.allocations += GetTotalAllocationCount() - allocations;
+        result.ops++;
+    }
+
+    ShutdownGame(&config);
+    return result;
+}
+
+/* One TickGame per op over an endless session with the autopilot. The first
+ * and the last BENCH_SESSION_TICKS are reported apart, recycling rows for the
+ * whole session must neither slow ticks down nor allocate */
+void BenchEndless(
+    const Configuration *base, BenchResult *first, BenchResult *last
+) {
+    Configuration config;
+    memcpy(&config, base, sizeof(Configuration));
+    config.scroll_speed = BENCH_ENDLESS_SCROLL_SPEED;
+
+    InitGame(&config);
+
+    *first = (BenchResult){ 0 };
+    *last = (BenchResult){ 0 };
+
+    for (long tick = 0; tick < BENCH_ENDLESS_TICKS; tick++) {
+        BenchResult *result = NULL;
+
+        if (tick < BENCH_SESSION_TICKS) {
+            result = first;
+        } else if (tick >= BENCH_ENDLESS_TICKS - BENCH_SESSION_TICKS) {
+            result = last;
+        }
+
+        GameInput input = AutopilotInput(&config, tick, NULL);
+        long      allocations = GetTotalAllocationCount();
+        uint64_t  start = GetClockNanoseconds();
+
+        TickGame(&config, &input);
+
+        if (result) {
+            result->nanoseconds += GetClockNanoseconds() - start;
+            result->allocations += GetTotalAllocationCount() - allocations;
+            result->ops++;
+            result->bodies = b2World_GetCounters(config.world_id).bodyCount;
+        }
+    }
+
+    ShutdownGame(&config);
+}
+
+/*
+ * One AdvanceRollback per op that finds the remote input of the last depth
+ * ticks mispredicted, so it restores the remote field and resimulates depth
+ * ticks before running its own. The remote inputs come from AddRemoteInput,
+ * without a transport. worst_nanoseconds is the slowest op.
+ */
+BenchResult BenchRollback(
+    const Configuration *base, int depth, double *worst_nanoseconds
+) {
+    BenchResult     result = { 0 };
+    RollbackOptions options = DefaultRollbackOptions();
+    options.max_depth = ROLLBACK_MAX_DEPTH;
+    options.input_delay = 0;
+
+    RollbackSession *session = CreateRollbackSession(base, &options, NULL);
+    GameInput        idle = { 0 };
+    GameInput        moving = { .move_left = true };
+
+    *worst_nanoseconds = 0.0;
+
+    while (result.nanoseconds < BENCH_MIN_SECONDS * 1e9
+           && result.ops < BENCH_MAX_OPS) {
+        // NOTE: a cleared field ends the match
+        if (IsRollbackOver(session)) {
+            DestroyRollbackSession(session);
+            session = CreateRollbackSession(base, &options, NULL);
+        }
+
+        const Configuration *local = GetRollbackConfiguration(session, 0);
+        long                 first = GetRollbackTick(session);
+
+        // NOTE: the remote paddle is predicted to stay idle
+        for (int i = 0; i < depth; i++) {
+            GameInput input =
+                AutopilotInput(local, GetRollbackTick(session), NULL);
+            AdvanceRollback(session, &input);
+        }
+
+        for (int i = 0; i < depth; i++) {
+            AddRemoteInput(session, first + i, moving);
+        }
+
+        GameInput input = AutopilotInput(local, GetRollbackTick(session), NULL);
+        long      allocations = GetTotalAllocationCount();
+        uint64_t  start = GetClockNanoseconds();
+
+        AdvanceRollback(session, &input);
+
+        double nanoseconds = GetClockNanoseconds() - start;
+
+        result.nanoseconds += nanoseconds;
+        result.allocations += GetTotalAllocationCount() - allocations;
+        result.ops++;
+
+        if (nanoseconds > *worst_nanoseconds) {
+            *worst_nanoseconds = nanoseconds;
+        }
+
+        // NOTE: the remote paddle stops again, the next op rolls this one
+        // tick back before its own ticks are predicted idle
+        AddRemoteInput(session, first + depth, idle);
+    }
+
+    DestroyRollbackSession(session);
+    return result;
+}
+
+BenchResult BenchProcessConfiguration(const char *path) {
+    BenchResult result = { 0 };
+
+    while (result.nanoseconds < BENCH_MIN_SECONDS * 1e9
+           && result.ops < BENCH_MAX_OPS) {
+        Configuration config = DefaultConfiguration();
+
+        long     allocations = GetTotalAllocationCount();
+        uint64_t start = GetClockNanoseconds();
+
+        if (!ProcessConfiguration(path, &config)) {
+            break;
+        }
+
+        result.nanoseconds += GetClockNanoseconds() - start;
+        result.allocations += GetTotalAllocationCount() - allocations;
+        result.ops++;
+    }
+
+    return result;
+}
+
+bool WriteBenchConfiguration(const char *path) {
+    FILE *file = fopen(path, "w");
+
+    if (!file) {
+        fprintf(stderr, "Failed to write \"%s\"\n", path);
+        return false;
+    }
+
+    fprintf(file, "[game]\n");
+    fprintf(file, "bricks_in_row = %d\n", BRICKS_IN_ROW);
+    fprintf(file, "tick_rate = %d\n", DEFAULT_TICK_RATE);
+    fprintf(file, "max_frame_ticks = %d\n", DEFAULT_MAX_FRAME_TICKS);
+    fprintf(file, "worker_count = %d\n\n", DEFAULT_WORKER_COUNT);
+    fprintf(file, "[player]\n");
+    fprintf(file, "width = 100.0\nheight = 20.0\nmovement_speed = 500.0\n\n");
+    fprintf(file, "[ball]\n");
+    fprintf(file, "radius = 8.0\nmin_speed_multiplier = 0.8\n");
+
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    BenchArguments arguments = {
+        .max_bricks = brick_counts[BRICK_COUNTS_LENGTH - 1],
+        .max_balls = ball_counts[BALL_COUNTS_LENGTH - 1],
+        .worker_count = BENCH_DEFAULT_WORKERS,
+    };
+
+    if (!ParseArguments(argc, argv, &arguments)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    // NOTE: allocs/op counts every allocation made through the allocator hooks
+    InstallAllocators();
+
+    const char *configuration_path = arguments.configuration_path;
+
+    if (!configuration_path) {
+        if (!WriteBenchConfiguration(BENCH_CONFIGURATION_PATH)) {
+            return 1;
+        }
+        configuration_path = BENCH_CONFIGURATION_PATH;
+    }
+
+    Configuration base = DefaultConfiguration();
+
+    if (arguments.configuration_path) {
+        ProcessConfiguration(arguments.configuration_path, &base);
+    }
+
+    // NOTE: base never gets a scheduler, its Box2D steps are single threaded
+    TaskScheduler *scheduler = CreateTaskScheduler(arguments.worker_count);
+    Configuration  threaded;
+    memcpy(&threaded, &base, sizeof(Configuration));
+    threaded.worker_count = arguments.worker_count;
+    threaded.scheduler = scheduler;
+
+    char threaded_name[32];
+    snprintf(
+        threaded_name,
+        sizeof(threaded_name),
+        "step %s %ld workers",
+        BOX2D_PHYSICS.name,
+        arguments.worker_count
+    );
+
+    printf(
+        "%-24s %8s %14s %12s %10s %8s %10s\n",
+        "benchmark",
+        "bricks",
+        "ns/op",
+        "allocs/op",
+        "ops",
+        "bodies",
+        "balls/ms"
+    );
+
+    BenchResult configuration_result =
+        BenchProcessConfiguration(configuration_path);
+    PrintResult("ProcessConfiguration", 0, &configuration_result);
+
+    if (!arguments.configuration_path) {
+        remove(BENCH_CONFIGURATION_PATH);
+    }
+
+    for (size_t i = 0; i < BRICK_COUNTS_LENGTH; i++) {
+        int bricks = brick_counts[i];
+
+        if (bricks > arguments.max_bricks) {
+            break;
+        }
+
+        BenchResult level_result = BenchLoadLevel(bricks);
+        PrintResult("OpenLevel", bricks, &level_result);
+
+        BenchResult create_result = BenchCreateBricks(&base, bricks);
+        PrintResult("CreateBricks", bricks, &create_result);
+
+        for (int kind = 0; kind < PHYSICS_KIND_COUNT; kind++) {
+            const PhysicsBackend *physics = GetPhysicsBackend(kind);
+
+            char step_name[32];
+            char collisions_name[32];
+            snprintf(step_name, sizeof(step_name), "step %s", physics->name);
+            snprintf(
+                collisions_name,
+                sizeof(collisions_name),
+                "collisions %s",
+                physics->name
+            );
+
+            BenchResult step_result;
+            BenchResult collisions_result;
+            BenchTicks(
+                &base, physics, bricks, &step_result, &collisions_result
+            );
+            PrintResult(step_name, bricks, &step_result);
+            PrintResult(collisions_name, bricks, &collisions_result);
+        }
+
+        // NOTE: the analytic physics has no world to step in parallel
+        BenchResult threaded_step;
+        BenchResult threaded_collisions;
+        BenchTicks(
+            &threaded,
+            &BOX2D_PHYSICS,
+            bricks,
+            &threaded_step,
+            &threaded_collisions
+        );
+        PrintResult(threaded_name, bricks, &threaded_step);
+    }
+
+    DestroyTaskScheduler(scheduler);
+
+    BenchResult endless_first;
+    BenchResult endless_last;
+    BenchEndless(&base, &endless_first, &endless_last);
+    printf("\n");
+    PrintResult("TickGame endless first", 0, &endless_first);
+    PrintResult("TickGame endless last", 0, &endless_last);
+
+    printf("\nball kernels: %s\n", GetBallKernelName());
+
+    for (size_t i = 0; i < BALL_COUNTS_LENGTH; i++) {
+        int balls = ball_counts[i];
+
+        if (balls > arguments.max_balls) {
+            break;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "TickBallSwarm x%d", balls);
+
+        BenchResult swarm_result = BenchBallSwarm(&base, balls);
+        PrintResult(
+            name, (int)(base.bricks_in_row * ROWS_NUMBER), &swarm_result
+        );
+    }
+
+    printf("\n");
+
+    double worst_nanoseconds = 0.0;
+
+    for (size_t i = 0; i < ROLLBACK_DEPTHS_LENGTH; i++) {
+        int depth = rollback_depths[i];
+
+        char name[32];
+        snprintf(name, sizeof(name), "rollback depth %d", depth);
+
+        BenchResult rollback_result =
+            BenchRollback(&base, depth, &worst_nanoseconds);
+        PrintResult(
+            name, (int)(base.bricks_in_row * ROWS_NUMBER), &rollback_result
+        );
+    }
+
+    // NOTE: the deepest rollback is measured last
+    printf(
+        "\nworst rollback of %d ticks: %.3f ms, %.1f%% of a 60 Hz frame\n",
+        ROLLBACK_MAX_DEPTH,
+        worst_nanoseconds / 1e6,
+        worst_nanoseconds / 1e6 / BENCH_FRAME_MILLISECONDS * 100.0
+    );
+
+    return 0;
+}
@@ -0,0 +1,23 @@
+#include <stdio.h>
+#include <breakout/level.h>
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        printf("Usage: %s <level.toml> <level.bklv>\n", argv[0]);
+        return 1;
+    }
+
+    if (!CompileLevel(argv[1], argv[2])) {
+        return 1;
+    }
+
+    LevelFile level;
+
+    if (!OpenLevel(&level, argv[2])) {
+        return 1;
+    }
+
+    printf("Compiled %d bricks into \"%s\"\n", level.brick_count, argv[2]);
+    CloseLevel(&level);
+    return 0;
+}
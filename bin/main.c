@@ -1,520 +1,1206 @@
 #include <raylib.h>
-#include <tomlc17.h>
 #include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <box2d/box2d.h>
+#include <breakout/config_watcher.h>
+#include <breakout/game.h>
+#include <breakout/headless.h>
+#include <breakout/net_transport.h>
+#include <breakout/profiler.h>
+#include <breakout/render_state.h>
+#include <breakout/replay.h>
+#include <breakout/rollback.h>
+#include <breakout/snapshot.h>
+#include <breakout/spsc_ring.h>
+#include <breakout/telemetry.h>
+#include <stdatomic.h>
+#include <threads.h>
 
 #define DEBUG_LINE_LENGTH 50.f
 
-#define WIDTH  1280
-#define HEIGHT 720
-
-#define ROWS_NUMBER        8
-#define BRICKS_PADDING     15.f
-#define BRICKS_MARGIN      10.f
-#define BRICKS_AREA_HEIGHT 300.f
-#define BRICKS_IN_ROW 8
-
-#define WALLS_WIDTH 10.f
-
-#define PHYSICS_SUBSTEP_COUNT 4
-
-#define BALL_COLLISION_DISTANCE 3.f
-
-#define PIXELS_PER_METER 50.0f
-#define METERS_PER_PIXEL (1.0f / PIXELS_PER_METER)
+#define SCRIPT_TICKS_PER_MOVE 30
+
+// NOTE: sorting the whole ring every frame would show up in the profile
+#define PROFILER_OVERLAY_REFRESH_FRAMES 30
+
+// NOTE: the simulation drains the queue every tick, it only fills up when
+// the simulation thread stalls
+#define INPUT_QUEUE_CAPACITY 64
+
+/*
+ * Brick field cached in a render texture. drawn mirrors the live bitset as it
+ * was last rendered, so only bricks whose bit changed since are touched.
+ */
+typedef struct BrickLayer {
+    RenderTexture2D texture;
+    uint64_t       *drawn;
+    int             word_count;
+    long            layout_version;
+} BrickLayer;
+
+/* Input of one render frame as forwarded to the simulation thread */
+typedef struct FrameInput {
+    GameInput input;
+    bool      rewind;
+} FrameInput;
+
+typedef struct Arguments {
+    const char           *configuration_path;
+    bool                  headless;
+    bool                  compare_workers;
+    bool                  compare_physics;
+    const PhysicsBackend *physics;
+    long                  tick_rate;
+    long                  worker_count;
+    long                  ball_count;
+    const char           *level_path;
+    const char           *record_path;
+    const char           *replay_path;
+    long                  hash_interval;
+    bool                  watch;
+    bool                  endless;
+    bool                  profile;
+    const char           *profile_path;
+    const char           *telemetry_path;
+    // NOTE: 1 or 2, 0 outside of versus mode
+    long                  versus;
+    long                  port;
+    const char           *peer;
+    NetConditions         conditions;
+    RollbackOptions       rollback;
+    HeadlessOptions       headless_options;
+    InputScript           script;
+} Arguments;
+
+/*
+ * Simulation thread state. While the thread runs it owns the Configuration,
+ * the rewind ring and the watcher, the render thread only pushes into inputs
+ * and reads render_states.
+ */
+typedef struct Simulation {
+    Configuration    *config;
+    GameClock         clock;
+    SnapshotRing      rewind;
+    ConfigWatcher    *watcher;
+    // NOTE: reapplied to every reloaded configuration
+    const Arguments  *arguments;
+    RenderStateBuffer render_states;
+    SpscRing          inputs;
+    // NOTE: versus mode, config is the local player's field of the session
+    RollbackSession  *versus;
+    atomic_bool       running;
+    long              tick;
+    // NOTE: moves whenever the brick field is rebuilt
+    long              layout_version;
+    ProfileStats      profile_stats[PROFILE_PHASE_COUNT];
+} Simulation;
+
+void PrintUsage(const char *program) {
+    printf("Usage: %s [options] [path_to_config.toml]\n", program);
+    printf("Options:\n");
+    printf("  --headless          run the simulation without a window\n");
+    printf("  --games <n>         number of games to play headless\n");
+    printf("  --ticks <n>         tick limit of a single headless game\n");
+    printf("  --tick-rate <n>     fixed simulation ticks per second\n");
+    printf("  --workers <n>       threads used to step the physics world\n");
+    printf("  --compare-workers   run headless single threaded, then with\n");
+    printf("                      the configured workers on the same level\n");
+    printf("  --physics <name>    box2d (the default) or analytic\n");
+    printf("  --compare-physics   run headless on both backends, then check\n");
+    printf("                      that their ball trajectories agree\n");
+    printf("  --level <file>      play a level compiled by breakout_levelc\n");
+    printf("  --balls <n>         multi-ball mode, n more balls\n");
+    printf("  --endless           scroll the bricks down, new rows come in\n");
+    printf("  --record <file>     record the input of the session\n");
+    printf("  --hash-interval <n> ticks between state hashes in a recording\n");
+    printf("  --replay <file>     play a recording back uncapped and check it\n");
+    printf("  --script <moves>    scripted input instead of the autopilot,\n");
+    printf("                      L - left, R - right, S - reset, . - idle\n");
+    printf("  --watch             reload the configuration when it changes\n");
+    printf("  --profile           time the frame phases, F3 shows them\n");
+    printf("  --profile-csv <csv> same, the samples are written on exit\n");
+    printf("  --telemetry <log>   log gameplay events\n");
+    printf("  --versus <1|2>      play a versus match as player 1 or 2\n");
+    printf("  --port <n>          UDP port to bind, 7777 for player 1 and\n");
+    printf("                      7778 for player 2 by default\n");
+    printf("  --peer <host:port>  the other player, loopback by default\n");
+    printf("  --latency <ms>      delay every packet sent by this much\n");
+    printf("  --loss <percent>    drop this share of the packets sent\n");
+    printf("  --rollback <ticks>  deepest rollback before the match stalls\n");
+    printf("  --input-delay <n>   ticks before a local input is played\n");
+}
 
-#define WORLD_TO_PIXELS(x) ((x) * PIXELS_PER_METER)
-#define PIXELS_TO_WORLD(x) ((x) * METERS_PER_PIXEL)
+bool ParseArguments(int argc, char **argv, Arguments *arguments) {
+    for (int i = 1; i < argc; i++) {
+        const char *argument = argv[i];
+        bool        has_value = i + 1 < argc;
+
+        if (strcmp(argument, "--headless") == 0) {
+            arguments->headless = true;
+        } else if (strcmp(argument, "--games") == 0 && has_value) {
+            arguments->headless_options.games = atol(argv[++i]);
+        } else if (strcmp(argument, "--ticks") == 0 && has_value) {
+            arguments->headless_options.max_ticks = atol(argv[++i]);
+        } else if (strcmp(argument, "--tick-rate") == 0 && has_value) {
+            arguments->tick_rate = atol(argv[++i]);
+            if (arguments->tick_rate <= 0) {
+                fprintf(stderr, "Tick rate must be positive\n");
+                return false;
+            }
+        } else if (strcmp(argument, "--workers") == 0 && has_value) {
+            arguments->worker_count = atol(argv[++i]);
+            if (arguments->worker_count < 1
+                || arguments->worker_count > TASK_SCHEDULER_MAX_WORKERS) {
+                fprintf(
+                    stderr,
+                    "Worker count must be between 1 and %d\n",
+                    TASK_SCHEDULER_MAX_WORKERS
+                );
+                return false;
+            }
+        } else if (strcmp(argument, "--compare-workers") == 0) {
+            arguments->headless = true;
+            arguments->compare_workers = true;
+        } else if (strcmp(argument, "--physics") == 0 && has_value) {
+            arguments->physics = FindPhysicsBackend(argv[++i]);
+            if (!arguments->physics) {
+                fprintf(stderr, "Unknown physics \"%s\"\n", argv[i]);
+                return false;
+            }
+        } else if (strcmp(argument, "--compare-physics") == 0) {
+            arguments->headless = true;
+            arguments->compare_physics = true;
+        } else if (strcmp(argument, "--balls") == 0 && has_value) {
+            arguments->ball_count = atol(argv[++i]);
+            if (arguments->ball_count <= 0) {
+                fprintf(stderr, "Ball count must be positive\n");
+                return false;
+            }
+        } else if (strcmp(argument, "--endless") == 0) {
+            arguments->endless = true;
+        } else if (strcmp(argument, "--level") == 0 && has_value) {
+            arguments->level_path = argv[++i];
+        } else if (strcmp(argument, "--record") == 0 && has_value) {
+            arguments->record_path = argv[++i];
+        } else if (strcmp(argument, "--hash-interval") == 0 && has_value) {
+            arguments->hash_interval = atol(argv[++i]);
+        } else if (strcmp(argument, "--replay") == 0 && has_value) {
+            arguments->replay_path = argv[++i];
+        } else if (strcmp(argument, "--script") == 0 && has_value) {
+            arguments->script.moves = argv[++i];
+            arguments->headless_options.input_source = ScriptedInput;
+            arguments->headless_options.input_user_data = &arguments->script;
+        } else if (strcmp(argument, "--watch") == 0) {
+            arguments->watch = true;
+        } else if (strcmp(argument, "--profile") == 0) {
+            arguments->profile = true;
+        } else if (strcmp(argument, "--profile-csv") == 0 && has_value) {
+            arguments->profile = true;
+            arguments->profile_path = argv[++i];
+        } else if (strcmp(argument, "--telemetry") == 0 && has_value) {
+            arguments->telemetry_path = argv[++i];
+        } else if (strcmp(argument, "--versus") == 0 && has_value) {
+            arguments->versus = atol(argv[++i]);
+            if (arguments->versus < 1
+                || arguments->versus > ROLLBACK_PLAYER_COUNT) {
+                fprintf(stderr, "Versus player must be 1 or 2\n");
+                return false;
+            }
+        } else if (strcmp(argument, "--port") == 0 && has_value) {
+            arguments->port = atol(argv[++i]);
+            if (arguments->port < 1 || arguments->port > 65535) {
+                fprintf(stderr, "Port must be between 1 and 65535\n");
+                return false;
+            }
+        } else if (strcmp(argument, "--peer") == 0 && has_value) {
+            arguments->peer = argv[++i];
+        } else if (strcmp(argument, "--latency") == 0 && has_value) {
+            arguments->conditions.latency_milliseconds = atol(argv[++i]);
+            if (arguments->conditions.latency_milliseconds < 0
+                || arguments->conditions.latency_milliseconds
+                       > NET_MAX_LATENCY_MILLISECONDS) {
+                fprintf(
+                    stderr,
+                    "Latency must be between 0 and %d ms\n",
+                    NET_MAX_LATENCY_MILLISECONDS
+                );
+                return false;
+            }
+        } else if (strcmp(argument, "--loss") == 0 && has_value) {
+            arguments->conditions.loss = atof(argv[++i]) / 100.0;
+            if (arguments->conditions.loss < 0.0
+                || arguments->conditions.loss > 1.0) {
+                fprintf(stderr, "Loss must be between 0 and 100 percent\n");
+                return false;
+            }
+        } else if (strcmp(argument, "--rollback") == 0 && has_value) {
+            arguments->rollback.max_depth = atoi(argv[++i]);
+            if (arguments->rollback.max_depth < 1
+                || arguments->rollback.max_depth > ROLLBACK_MAX_DEPTH) {
+                fprintf(
+                    stderr,
+                    "Rollback must be between 1 and %d ticks\n",
+                    ROLLBACK_MAX_DEPTH
+                );
+                return false;
+            }
+        } else if (strcmp(argument, "--input-delay") == 0 && has_value) {
+            arguments->rollback.input_delay = atoi(argv[++i]);
+            if (arguments->rollback.input_delay < 0
+                || arguments->rollback.input_delay
+                       > ROLLBACK_MAX_INPUT_DELAY) {
+                fprintf(
+                    stderr,
+                    "Input delay must be between 0 and %d ticks\n",
+                    ROLLBACK_MAX_INPUT_DELAY
+                );
+                return false;
+            }
+        } else if (strncmp(argument, "--", 2) == 0) {
+            fprintf(stderr, "Unknown or incomplete option \"%s\"\n", argument);
+            return false;
+        } else {
+            arguments->configuration_path = argument;
+        }
+    }
 
-typedef struct Ball {
-    Color    color;
-    double   radius;
-    double   max_speed;
-    double   min_speed_multiplier;
-    b2Vec2   initial_velocity;
-    b2BodyId body_id;
-} Ball;
+    if (arguments->watch && !arguments->configuration_path) {
+        fprintf(stderr, "There is no configuration file to watch\n");
+        return false;
+    }
 
-typedef struct Brick {
-    Vector2  position;
-    int      active;
-    b2BodyId body_id;
-} Brick;
+    // NOTE: recordings describe the level by bricks_in_row only
+    if (arguments->level_path
+        && (arguments->record_path || arguments->replay_path)) {
+        fprintf(stderr, "Levels cannot be recorded or replayed yet\n");
+        return false;
+    }
 
-typedef struct Player {
-    double    movement_speed;
-    double    width;
-    double    height;
-    Color     color;
-    b2BodyId  body_id;
-    b2Polygon collider;
-} Player;
+    if (arguments->endless
+        && (arguments->level_path || arguments->record_path
+            || arguments->replay_path)) {
+        fprintf(
+            stderr,
+            "Endless mode cannot play a level, be recorded or replayed yet\n"
+        );
+        return false;
+    }
 
-typedef struct Configuration {
-    long        bricks_in_row;
-    double      brick_width;
-    double      brick_height;
-    Color       background_color;
-    const Color rows_colors[ROWS_NUMBER];
-    Player      player;
-    Ball        ball;
-    Brick      *bricks;
-    b2WorldId   world_id;
-} Configuration;
+    if (arguments->endless && arguments->physics
+        && arguments->physics->kind != PHYSICS_BOX2D) {
+        fprintf(stderr, "Endless mode needs the Box2D physics\n");
+        return false;
+    }
 
-void ProcessInput(Configuration *config) {
-    Player *player = &config->player;
+    if (arguments->compare_physics
+        && (arguments->compare_workers || arguments->record_path
+            || arguments->endless)) {
+        fprintf(
+            stderr,
+            "Physics comparisons cannot compare workers, be recorded or "
+            "scroll\n"
+        );
+        return false;
+    }
 
-    if (IsKeyDown(KEY_ESCAPE)) {
-        CloseWindow();
+    if (arguments->ball_count > 0
+        && (arguments->record_path || arguments->replay_path)) {
+        fprintf(
+            stderr, "Multi-ball sessions cannot be recorded or replayed yet\n"
+        );
+        return false;
     }
 
-    b2Vec2 velocity = b2Vec2_zero;
+    if (arguments->record_path && arguments->headless
+        && arguments->headless_options.games > 1) {
+        fprintf(stderr, "Only a single headless game can be recorded\n");
+        return false;
+    }
 
-    if (IsKeyDown(KEY_A) || IsKeyDown(KEY_J)) {
-        velocity.x = -PIXELS_TO_WORLD(player->movement_speed);
+    // NOTE: the session snapshots a single ball and a fixed field, and the
+    // peers have to step both fields the same way
+    if (arguments->versus
+        && (arguments->record_path || arguments->replay_path
+            || arguments->endless || arguments->ball_count > 0
+            || arguments->watch || arguments->profile
+            || arguments->telemetry_path || arguments->compare_workers
+            || arguments->compare_physics)) {
+        fprintf(
+            stderr,
+            "Versus matches cannot be recorded, replayed, compared, profiled, "
+            "reloaded, logged or have more balls or scroll yet\n"
+        );
+        return false;
     }
 
-    if (IsKeyDown(KEY_D) || IsKeyDown(KEY_K)) {
-        velocity.x = PIXELS_TO_WORLD(player->movement_speed);
+    if (arguments->versus && arguments->physics
+        && arguments->physics->kind != PHYSICS_ANALYTIC) {
+        fprintf(stderr, "Versus mode needs the analytic physics\n");
+        return false;
     }
 
+    return true;
+}
+
+GameInput SampleKeyboardInput(void) {
+    GameInput input = {
+        .move_left = IsKeyDown(KEY_A) || IsKeyDown(KEY_J),
+        .move_right = IsKeyDown(KEY_D) || IsKeyDown(KEY_K),
+    };
+
 #ifdef DEBUGGING
-    if (IsKeyPressed(KEY_SPACE)) {
-        b2Vec2 restart_position =
-            (b2Vec2){ PIXELS_TO_WORLD((double)WIDTH / 2),
-                      PIXELS_TO_WORLD(HEIGHT - (double)HEIGHT / 2) };
-        b2Body_SetTransform(
-            config->ball.body_id, restart_position, b2Rot_identity
-        );
-        b2Body_SetLinearVelocity(
-            config->ball.body_id, config->ball.initial_velocity
-        );
-    }
+    input.reset_ball = IsKeyPressed(KEY_SPACE);
 #endif
 
-    b2Body_SetLinearVelocity(config->player.body_id, velocity);
+    return input;
 }
 
-void CalculateBrickDimensions(Configuration *config) {
-    double available_width = WIDTH - BRICKS_MARGIN * 2;
-    double horizontal_padding = (config->bricks_in_row - 1) * BRICKS_PADDING;
-    config->brick_width =
-        (available_width - horizontal_padding) / config->bricks_in_row;
+Rectangle GetBrickRectangle(const RenderState *state, int brick_index) {
+    Vector2 position = state->brick_positions[brick_index];
+    Vector2 size = state->brick_sizes[brick_index];
 
-    double available_height = BRICKS_AREA_HEIGHT;
-    double vertical_padding = (ROWS_NUMBER - 1) * BRICKS_PADDING;
-    config->brick_height = (available_height - vertical_padding) / ROWS_NUMBER;
+    return (Rectangle){ position.x, position.y, size.x, size.y };
 }
 
-void ClampPlayerMovement(const Player *player) {
-    b2Vec2 position = b2Body_GetPosition(player->body_id);
+BrickLayer CreateBrickLayer(void) {
+    return (BrickLayer){ .texture = LoadRenderTexture(WIDTH, HEIGHT) };
+}
 
-    double half_width = PIXELS_TO_WORLD(player->width / 2);
+void UnloadBrickLayer(BrickLayer *layer) {
+    UnloadRenderTexture(layer->texture);
+    MemoryFree(layer->drawn);
+    *layer = (BrickLayer){ 0 };
+}
 
-    if (position.x - half_width < 0.f) {
-        position.x = half_width;
-        b2Body_SetTransform(player->body_id, position, b2Rot_identity);
+void UpdateBrickLayer(BrickLayer *layer, const RenderState *state) {
+    // NOTE: the cached field belongs to the old layout
+    if (layer->layout_version != state->layout_version) {
+        MemoryFree(layer->drawn);
+        layer->word_count = state->word_count;
+        layer->layout_version = state->layout_version;
+        layer->drawn =
+            MemoryCalloc(MEMORY_GAME, layer->word_count, sizeof(uint64_t));
+
+        BeginTextureMode(layer->texture);
+        ClearBackground(BLANK);
+        EndTextureMode();
     }
-    if (position.x + half_width > PIXELS_TO_WORLD(WIDTH)) {
-        position.x = PIXELS_TO_WORLD(WIDTH) - half_width;
-        b2Body_SetTransform(player->body_id, position, b2Rot_identity);
+
+    bool texture_mode = false;
+
+    for (int word = 0; word < state->word_count; word++) {
+        uint64_t changed = layer->drawn[word] ^ state->live[word];
+
+        if (changed == 0) {
+            continue;
+        }
+
+        if (!texture_mode) {
+            BeginTextureMode(layer->texture);
+            texture_mode = true;
+        }
+
+        for (int bit = 0; bit < BRICK_STORE_WORD_BITS; bit++) {
+            if (!((changed >> bit) & 1)) {
+                continue;
+            }
+
+            int       brick_index = word * BRICK_STORE_WORD_BITS + bit;
+            Rectangle rectangle = GetBrickRectangle(state, brick_index);
+
+            if ((state->live[word] >> bit) & 1) {
+                DrawRectangleRec(rectangle, state->brick_colors[brick_index]);
+            } else {
+                // NOTE: clear is limited by the scissor, blending would keep
+                // the old pixels under a transparent rectangle
+                int left = (int)floorf(rectangle.x);
+                int top = (int)floorf(rectangle.y);
+                BeginScissorMode(
+                    left,
+                    top,
+                    (int)ceilf(rectangle.x + rectangle.width) - left,
+                    (int)ceilf(rectangle.y + rectangle.height) - top
+                );
+                ClearBackground(BLANK);
+                EndScissorMode();
+            }
+        }
+
+        layer->drawn[word] = state->live[word];
     }
-}
 
-void ClampBallMovement(const Configuration *config) {
-    b2Vec2 velocity = b2Body_GetLinearVelocity(config->ball.body_id);
-    double current_speed =
-        sqrtf(velocity.x * velocity.x + velocity.y * velocity.y);
-
-    if (current_speed > config->ball.max_speed) {
-        double scale = config->ball.max_speed / current_speed;
-        b2Vec2 clamped_velocity = { velocity.x * scale, velocity.y * scale };
-        b2Body_SetLinearVelocity(config->ball.body_id, clamped_velocity);
-    } else if (current_speed > 0.1f
-               && current_speed < config->ball.max_speed * 0.5f) {
-        double target_speed =
-            config->ball.max_speed * config->ball.min_speed_multiplier;
-        double scale = target_speed / current_speed;
-        b2Vec2 boosted_velocity = { velocity.x * scale, velocity.y * scale };
-        b2Body_SetLinearVelocity(config->ball.body_id, boosted_velocity);
+    if (texture_mode) {
+        EndTextureMode();
     }
 }
 
-void DrawBricks(const Configuration *config) {
-    for (int i = 0; i < config->bricks_in_row; i++) {
-        for (int j = 0; j < ROWS_NUMBER; j++) {
-            int      brick_index = i + j * config->bricks_in_row;
-            Vector2 *position = &config->bricks[brick_index].position;
+/* Endless mode, the field moves every tick so the live bricks on screen are
+ * drawn directly instead of through the cached layer */
+void DrawScrollingBricks(const RenderState *state) {
+    for (int word = 0; word < state->word_count; word++) {
+        uint64_t live = state->live[word];
+
+        for (int bit = 0; bit < BRICK_STORE_WORD_BITS; bit++) {
+            if (!((live >> bit) & 1)) {
+                continue;
+            }
 
-            int color_index = j % ROWS_NUMBER;
+            int       brick_index = word * BRICK_STORE_WORD_BITS + bit;
+            Rectangle rectangle = GetBrickRectangle(state, brick_index);
 
-            if (config->bricks[brick_index].active) {
-                DrawRectangleV(
-                    *position,
-                    (Vector2){ config->brick_width, config->brick_height },
-                    config->rows_colors[color_index]
-                );
+            if (rectangle.y + rectangle.height < 0.f
+                || rectangle.y > HEIGHT) {
+                continue;
             }
+
+            DrawRectangleRec(rectangle, state->brick_colors[brick_index]);
         }
     }
 }
 
-void DrawPlayer(Configuration *config) {
-    Player *player = &config->player;
-    b2Vec2  position = b2Body_GetPosition(player->body_id);
+void DrawBricks(BrickLayer *layer, const RenderState *state) {
+    if (state->scrolling) {
+        DrawScrollingBricks(state);
+        return;
+    }
+
+    UpdateBrickLayer(layer, state);
+
+    // NOTE: render textures are stored upside down
+    Texture2D texture = layer->texture.texture;
+    DrawTextureRec(
+        texture,
+        (Rectangle){ 0, 0, texture.width, -texture.height },
+        (Vector2){ 0, 0 },
+        WHITE
+    );
+}
+
+Vector2 InterpolatePosition(Vector2 previous, Vector2 current, double alpha) {
+    return (Vector2){
+        previous.x + (current.x - previous.x) * alpha,
+        previous.y + (current.y - previous.y) * alpha,
+    };
+}
 
-    double screen_x = WORLD_TO_PIXELS(position.x) - player->width / 2;
-    double screen_y = WORLD_TO_PIXELS(position.y) - player->height / 2;
+void DrawPlayer(const RenderState *state, double alpha) {
+    Vector2 position = InterpolatePosition(
+        state->player_previous, state->player_position, alpha
+    );
+
+    double screen_x = position.x - state->player_size.x / 2;
+    double screen_y = position.y - state->player_size.y / 2;
 
     DrawRectangle(
-        screen_x, screen_y, player->width, player->height, player->color
+        screen_x,
+        screen_y,
+        state->player_size.x,
+        state->player_size.y,
+        state->player_color
     );
 }
 
-void DrawBall(const Configuration *config) {
-    b2Vec2 position = b2Body_GetPosition(config->ball.body_id);
+void DrawBall(const RenderState *state, double alpha) {
+    Vector2 position =
+        InterpolatePosition(state->ball_previous, state->ball_position, alpha);
 
-    double screen_x = WORLD_TO_PIXELS(position.x);
-    double screen_y = WORLD_TO_PIXELS(position.y);
+    DrawCircleV(position, state->ball_radius, state->ball_color);
+}
+
+void DrawSwarm(const RenderState *state, double alpha) {
+    for (int i = 0; i < state->swarm_count; i++) {
+        Vector2 position = InterpolatePosition(
+            (Vector2){ state->swarm_previous_x[i], state->swarm_previous_y[i] },
+            (Vector2){ state->swarm_x[i], state->swarm_y[i] },
+            alpha
+        );
 
-    DrawCircle(screen_x, screen_y, config->ball.radius, config->ball.color);
+        DrawCircleV(position, state->ball_radius, state->ball_color);
+    }
 }
 
-void CreatePlayer(Configuration *config) {
-    b2BodyDef player_body_def = b2DefaultBodyDef();
-    player_body_def.type = b2_kinematicBody;
-    player_body_def.position =
-        (b2Vec2){ PIXELS_TO_WORLD((double)WIDTH / 2),
-                  PIXELS_TO_WORLD(HEIGHT - (double)HEIGHT / 5) };
-    config->player.body_id = b2CreateBody(config->world_id, &player_body_def);
-
-    b2Polygon player_collider = b2MakeBox(
-        PIXELS_TO_WORLD(config->player.width / 2),
-        PIXELS_TO_WORLD(config->player.height / 2)
+void DrawScore(const RenderState *state) {
+    const char *text =
+        state->opponent_score >= 0
+            ? TextFormat("%ld : %ld", state->score, state->opponent_score)
+            : TextFormat("%ld", state->score);
+
+    DrawText(text, WIDTH - 10 - MeasureText(text, 20), HEIGHT - 30, 20, WHITE);
+
+    if (state->message) {
+        int width = MeasureText(state->message, 40);
+        DrawText(
+            state->message, (WIDTH - width) / 2, HEIGHT / 2 - 20, 40, WHITE
+        );
+    }
+}
+
+void DrawProfilerOverlay(
+    const ProfileStats *stats,
+    const MemoryStats  *memory,
+    long                frame_allocations
+) {
+    const int font_size = 10;
+    const int line_height = 12;
+    const int left = WIDTH - 250;
+    const int top = 10;
+    // NOTE: phases, memory header, subsystems and the frame allocation count
+    const int line_count = PROFILE_PHASE_COUNT + MEMORY_SUBSYSTEM_COUNT + 3;
+
+    DrawRectangle(
+        left - 5,
+        top - 5,
+        245,
+        line_height * line_count + 10,
+        Fade(BLACK, 0.75f)
     );
-    b2ShapeDef player_shape_def = b2DefaultShapeDef();
-    player_shape_def.material.friction = 0.0f;
-    player_shape_def.material.restitution = 1.2f;
-    b2CreatePolygonShape(
-        config->player.body_id, &player_shape_def, &player_collider
+    DrawText("phase (ms)      min     avg     p99", left, top, font_size, WHITE);
+
+    for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+        DrawText(
+            TextFormat(
+                "%-12s %7.3f %7.3f %7.3f",
+                GetProfilePhaseName(phase),
+                stats[phase].min_milliseconds,
+                stats[phase].average_milliseconds,
+                stats[phase].p99_milliseconds
+            ),
+            left,
+            top + line_height * (phase + 1),
+            font_size,
+            WHITE
+        );
+    }
+
+    int memory_top = top + line_height * (PROFILE_PHASE_COUNT + 1);
+
+    DrawText(
+        "memory (KB)    in use    peak  allocs",
+        left,
+        memory_top,
+        font_size,
+        WHITE
     );
 
-    config->player.collider = player_collider;
+    for (int subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+        DrawText(
+            TextFormat(
+                "%-12s %8.1f %7.1f %7ld",
+                GetMemorySubsystemName(subsystem),
+                memory[subsystem].bytes_in_use / 1024.0,
+                memory[subsystem].peak_bytes / 1024.0,
+                memory[subsystem].allocation_count
+            ),
+            left,
+            memory_top + line_height * (subsystem + 1),
+            font_size,
+            WHITE
+        );
+    }
+
+    DrawText(
+        TextFormat("allocations last frame %ld", frame_allocations),
+        left,
+        memory_top + line_height * (MEMORY_SUBSYSTEM_COUNT + 1),
+        font_size,
+        WHITE
+    );
 }
 
-void CreateBall(Configuration *config) {
-    b2BodyDef ball_body_def = b2DefaultBodyDef();
-    ball_body_def.type = b2_dynamicBody;
-    ball_body_def.position =
-        (b2Vec2){ PIXELS_TO_WORLD((double)WIDTH / 2),
-                  PIXELS_TO_WORLD(HEIGHT - (double)HEIGHT / 2) };
-    ball_body_def.linearDamping = 0.0f;
-    ball_body_def.angularDamping = 0.0f;
-
-    config->ball.body_id = b2CreateBody(config->world_id, &ball_body_def);
-
-    b2Circle ball_collider = { { 0, 0 }, PIXELS_TO_WORLD(config->ball.radius) };
-    b2ShapeDef ball_shape_def = b2DefaultShapeDef();
-    ball_shape_def.material.restitution = 1.0f;
-    ball_shape_def.material.friction = 0.0f;
-    b2CreateCircleShape(config->ball.body_id, &ball_shape_def, &ball_collider);
+/* Phases timed on the render thread, the others come from the simulation */
+bool IsRenderPhase(ProfilePhase phase) {
+    return phase == PROFILE_PHASE_DRAW || phase == PROFILE_PHASE_PRESENT
+        || phase == PROFILE_PHASE_FRAME;
 }
 
-void CreateWalls(const Configuration *config) {
-    b2BodyDef wall_body_def = b2DefaultBodyDef();
-    wall_body_def.type = b2_staticBody;
+/* host:port split at the last colon, host holds capacity bytes */
+bool ParsePeer(const char *peer, char *host, int capacity, int *port) {
+    const char *colon = strrchr(peer, ':');
 
-    b2ShapeDef wall_shape_def = b2DefaultShapeDef();
-    wall_shape_def.material.restitution = 1.0f;
-    wall_shape_def.material.friction = 0.0f;
+    if (!colon || colon == peer || colon - peer >= capacity) {
+        return false;
+    }
+
+    *port = atoi(colon + 1);
+    memcpy(host, peer, colon - peer);
+    host[colon - peer] = '\0';
+    return *port >= 1 && *port <= 65535;
+}
 
-    wall_body_def.position = (b2Vec2){ PIXELS_TO_WORLD(-WALLS_WIDTH),
-                                       PIXELS_TO_WORLD((double)HEIGHT / 2) };
-    b2BodyId  left_wall = b2CreateBody(config->world_id, &wall_body_def);
-    b2Polygon left_wall_collider = b2MakeBox(
-        PIXELS_TO_WORLD(WALLS_WIDTH), PIXELS_TO_WORLD((double)HEIGHT / 2)
+NetTransport *OpenVersusTransport(const Arguments *arguments) {
+    // NOTE: player 1 binds the default port and player 2 the next one, two
+    // processes on one machine find each other without options
+    int  port = ROLLBACK_DEFAULT_PORT + (int)arguments->versus - 1;
+    int  peer_port = ROLLBACK_DEFAULT_PORT + 2 - (int)arguments->versus;
+    char host[256] = "127.0.0.1";
+
+    if (arguments->port > 0) {
+        port = (int)arguments->port;
+    }
+
+    if (arguments->peer
+        && !ParsePeer(arguments->peer, host, sizeof(host), &peer_port)) {
+        fprintf(stderr, "Peer must be given as host:port\n");
+        return NULL;
+    }
+
+    return OpenNetTransport(port, host, peer_port, arguments->conditions);
+}
+
+/* frames.csv becomes frames_render.csv */
+const char *GetRenderCsvPath(const char *path) {
+    const char *extension = strrchr(path, '.');
+    int         length =
+        extension ? (int)(extension - path) : (int)strlen(path);
+
+    return TextFormat(
+        "%.*s_render%s", length, path, extension ? extension : ".csv"
     );
-    b2CreatePolygonShape(left_wall, &wall_shape_def, &left_wall_collider);
+}
+
+const char *GetVersusMessage(RollbackOutcome outcome) {
+    switch (outcome) {
+    case ROLLBACK_WON:
+        return "You won";
+    case ROLLBACK_LOST:
+        return "You lost";
+    case ROLLBACK_DRAW:
+        return "Draw";
+    case ROLLBACK_DISCONNECTED:
+        return "The other player left";
+    default:
+        return NULL;
+    }
+}
 
-    wall_body_def.position = (b2Vec2){ PIXELS_TO_WORLD(WIDTH + WALLS_WIDTH),
-                                       PIXELS_TO_WORLD((double)HEIGHT / 2) };
-    b2BodyId  right_wall = b2CreateBody(config->world_id, &wall_body_def);
-    b2Polygon right_wall_collider = b2MakeBox(
-        PIXELS_TO_WORLD(WALLS_WIDTH), PIXELS_TO_WORLD((double)HEIGHT / 2)
+void PublishSimulation(Simulation *simulation) {
+    RenderState *state = GetRenderStateWriteSlot(&simulation->render_states);
+
+    CaptureRenderState(
+        state, simulation->config, simulation->tick, simulation->layout_version
     );
-    b2CreatePolygonShape(right_wall, &wall_shape_def, &right_wall_collider);
 
-    wall_body_def.position = (b2Vec2){ PIXELS_TO_WORLD((double)WIDTH / 2),
-                                       PIXELS_TO_WORLD(-WALLS_WIDTH) };
-    b2BodyId  up_wall = b2CreateBody(config->world_id, &wall_body_def);
-    b2Polygon up_wall_collider = b2MakeBox(
-        PIXELS_TO_WORLD((double)WIDTH / 2), PIXELS_TO_WORLD(WALLS_WIDTH)
+    state->opponent_score = -1;
+    state->message = NULL;
+
+    if (simulation->versus) {
+        RollbackStats stats = GetRollbackStats(simulation->versus);
+
+        state->opponent_score = GetRollbackScore(
+            simulation->versus, ROLLBACK_PLAYER_COUNT - 1 - stats.local_player
+        );
+        state->message = GetVersusMessage(stats.outcome);
+    }
+
+    state->has_profile_stats = simulation->config->profiler != NULL;
+    memcpy(
+        state->profile_stats,
+        simulation->profile_stats,
+        sizeof(state->profile_stats)
     );
-    b2CreatePolygonShape(up_wall, &wall_shape_def, &up_wall_collider);
+
+    PublishRenderState(&simulation->render_states);
 }
 
-void CreateBricks(Configuration *config) {
-    CalculateBrickDimensions(config);
+bool CanRewind(const Configuration *config) {
+    // NOTE: rewinding would break the recorded input stream, so it is only
+    // available when not recording. Snapshots do not hold swarm balls or the
+    // rows of a scrolling field either
+    return !config->recorder && config->ball_count == 0
+        && config->scroll_speed <= 0;
+}
 
-    b2BodyDef brick_body_def = b2DefaultBodyDef();
-    brick_body_def.type = b2_staticBody;
+/* Options given on the command line take precedence over the file, at
+ * startup as well as on every reload */
+void ApplyArgumentOverrides(const Arguments *arguments, Configuration *config) {
+    if (arguments->tick_rate > 0) {
+        config->tick_rate = arguments->tick_rate;
+    }
 
-    b2ShapeDef brick_shape_def = b2DefaultShapeDef();
-    brick_shape_def.material.restitution = 1.0f;
-    brick_shape_def.material.friction = 0.0f;
+    if (arguments->worker_count > 0) {
+        config->worker_count = arguments->worker_count;
+    }
 
-    Brick *bricks = config->bricks;
+    if (arguments->physics) {
+        config->physics = arguments->physics;
+    }
 
-    for (int i = 0; i < config->bricks_in_row; i++) {
-        for (int j = 0; j < ROWS_NUMBER; j++) {
-            int      brick_index = i + j * config->bricks_in_row;
-            Vector2 *position = &bricks[brick_index].position;
+    if (arguments->ball_count > 0) {
+        config->ball_count = arguments->ball_count;
+    }
 
-            bricks[brick_index].active = true;
+    // NOTE: a scroll speed set in the file is kept
+    if (arguments->endless && config->scroll_speed <= 0) {
+        config->scroll_speed = ENDLESS_DEFAULT_SCROLL_SPEED;
+    }
+}
 
-            position->x =
-                BRICKS_MARGIN + i * (config->brick_width + BRICKS_PADDING);
-            position->y =
-                BRICKS_MARGIN + j * (config->brick_height + BRICKS_PADDING);
+/* Returns true if a reloaded configuration was applied */
+bool ApplyReloadedConfiguration(Simulation *simulation) {
+    Configuration *config = simulation->config;
+    Configuration *reloaded = simulation->watcher
+                                ? TakeReloadedConfiguration(simulation->watcher)
+                                : NULL;
 
-            brick_body_def.position = (b2Vec2){
-                PIXELS_TO_WORLD(position->x + config->brick_width / 2),
-                PIXELS_TO_WORLD(position->y + config->brick_height / 2)
-            };
+    if (!reloaded) {
+        return false;
+    }
 
-            bricks[brick_index].body_id =
-                b2CreateBody(config->world_id, &brick_body_def);
+    ApplyArgumentOverrides(simulation->arguments, reloaded);
 
-            b2Polygon brick_collider = b2MakeBox(
-                PIXELS_TO_WORLD(config->brick_width / 3),
-                PIXELS_TO_WORLD(config->brick_height / 3)
-            );
-            b2CreatePolygonShape(
-                bricks[brick_index].body_id, &brick_shape_def, &brick_collider
-            );
-        }
+    // NOTE: AdvanceGame only runs whole ticks, so this is a tick boundary
+    if (ApplyConfiguration(config, reloaded)) {
+        simulation->layout_version++;
     }
+
+    // NOTE: older snapshots would bring back the old shapes' sizes without
+    // resizing the shapes
+    FreeSnapshotRing(&simulation->rewind);
+
+    if (CanRewind(config)) {
+        CreateSnapshotRing(
+            &simulation->rewind, config, SNAPSHOT_DEFAULT_RING_CAPACITY
+        );
+    }
+
+    simulation->clock.time_step = 1.0 / config->tick_rate;
+    simulation->clock.max_frame_ticks = config->max_frame_ticks;
+    FreeReloadedConfiguration(reloaded);
+    return true;
 }
 
-void CheckBallBrickCollisions(const Configuration *config) {
-    b2Vec2 ball_position = b2Body_GetPosition(config->ball.body_id);
+/* AdvanceGame for versus mode, one call into the session per time step.
+ * Returns the time steps passed, the session may have held some back */
+int AdvanceVersus(
+    Simulation *simulation, const GameInput *input, double frame_time
+) {
+    GameClock *clock = &simulation->clock;
+    int        steps = 0;
 
-    double ball_screen_x = WORLD_TO_PIXELS(ball_position.x);
-    double ball_screen_y = WORLD_TO_PIXELS(ball_position.y);
+    clock->accumulator += frame_time;
 
-    for (int i = 0; i < config->bricks_in_row; i++) {
-        for (int j = 0; j < ROWS_NUMBER; j++) {
-            int brick_index = i + j * config->bricks_in_row;
+    while (clock->accumulator >= clock->time_step) {
+        if (steps >= clock->max_frame_ticks) {
+            clock->accumulator = fmod(clock->accumulator, clock->time_step);
+            break;
+        }
 
-            if (!config->bricks[brick_index].active) {
-                continue;
+        AdvanceRollback(simulation->versus, input);
+        clock->accumulator -= clock->time_step;
+        steps++;
+    }
+
+    simulation->tick = GetRollbackTick(simulation->versus);
+    return steps;
+}
+
+/* Steps the game at its tick rate, however long the frames of the render
+ * thread take, and publishes a render state after every change */
+int SimulationMain(void *argument) {
+    Simulation    *simulation = argument;
+    Configuration *config = simulation->config;
+    GameClock     *clock = &simulation->clock;
+    FrameInput     frame_input = { 0 };
+    uint64_t       last_time = GetClockNanoseconds();
+
+    while (atomic_load(&simulation->running)) {
+        BeginProfilerFrame(config->profiler);
+
+        bool       changed = ApplyReloadedConfiguration(simulation);
+        FrameInput queued;
+
+        // NOTE: movement follows the newest frame, a reset pressed in any
+        // frame is kept until a tick runs with it
+        while (PopSpscRing(&simulation->inputs, &queued)) {
+            queued.input.reset_ball |= frame_input.input.reset_ball;
+            frame_input = queued;
+        }
+
+        uint64_t now = GetClockNanoseconds();
+        double   frame_time = (now - last_time) * 1e-9;
+        last_time = now;
+
+        if (simulation->rewind.buffer && frame_input.rewind) {
+            // NOTE: one snapshot per pass, passes run at the tick rate
+            if (PopSnapshot(&simulation->rewind, config, &simulation->tick)) {
+                clock->accumulator = 0.0;
+                changed = true;
             }
+        } else if (simulation->versus) {
+            // NOTE: the opponent's score and the result change without a
+            // local tick, so every step is published
+            if (AdvanceVersus(simulation, &frame_input.input, frame_time) > 0) {
+                frame_input.input.reset_ball = false;
+                changed = true;
+            }
+        } else {
+            int ticks =
+                AdvanceGame(config, clock, &frame_input.input, frame_time);
+
+            if (ticks > 0) {
+                simulation->tick += ticks;
+                frame_input.input.reset_ball = false;
+                changed = true;
 
-            Vector2 *position = &config->bricks[brick_index].position;
-
-            if (CheckCollisionCircleRec(
-                    (Vector2){ ball_screen_x, ball_screen_y },
-                    config->ball.radius + 1.f,
-                    (Rectangle){ position->x,
-                                 position->y,
-                                 config->brick_width,
-                                 config->brick_height }
-                )) {
-                if (!B2_IS_NULL(config->bricks[brick_index].body_id)) {
-                    b2DestroyBody(config->bricks[brick_index].body_id);
-                    config->bricks[brick_index].body_id = b2_nullBodyId;
+                if (simulation->rewind.buffer) {
+                    PushSnapshot(&simulation->rewind, config, simulation->tick);
                 }
+            }
+        }
 
-                config->bricks[brick_index].active = false;
+        if (config->profiler
+            && config->profiler->frame % PROFILER_OVERLAY_REFRESH_FRAMES == 0) {
+            for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+                simulation->profile_stats[phase] =
+                    GetProfileStats(config->profiler, phase);
+            }
+        }
 
-                b2Vec2 ball_vel =
-                    b2Body_GetLinearVelocity(config->ball.body_id);
-                b2Vec2 new_vel = { ball_vel.x, -ball_vel.y };
-                b2Body_SetLinearVelocity(config->ball.body_id, new_vel);
+        // NOTE: the frame ends before the wait, so it is the busy time only
+        EndProfilerFrame(config->profiler);
 
-                return;
-            }
+        if (changed) {
+            PublishSimulation(simulation);
         }
-    }
-}
 
-void DestroyAllBricks(const Configuration *config) {
-    for (int i = 0; i < config->bricks_in_row * ROWS_NUMBER; i++) {
-        if (!B2_IS_NULL(config->bricks[i].body_id)) {
-            b2DestroyBody(config->bricks[i].body_id);
-            config->bricks[i].body_id = b2_nullBodyId;
+        double wait = clock->time_step - clock->accumulator;
+
+        if (wait > 0.0) {
+            struct timespec duration = {
+                .tv_sec = (time_t)wait,
+                .tv_nsec = (long)(fmod(wait, 1.0) * 1e9),
+            };
+            thrd_sleep(&duration, NULL);
         }
     }
+
+    return 0;
 }
 
-#define TOML_GET_INT64(tab, key, var)                                                      \
-    {                                                                                      \
-        toml_datum_t value = toml_seek(tab, key);                                          \
-        if (value.type != TOML_INT64) {                                                    \
-            fprintf(                                                                       \
-                stderr,                                                                    \
-                "Failed to parse int64 from configuration with key \"%s\", skipping...\n", \
-                key                                                                        \
-            );                                                                             \
-        } else {                                                                           \
-            var = value.u.int64;                                                           \
-        }                                                                                  \
-    }
-
-#define TOML_GET_F64(tab, key, var)                                                          \
-    {                                                                                        \
-        toml_datum_t value = toml_seek(tab, key);                                            \
-        if (value.type != TOML_FP64) {                                                       \
-            fprintf(                                                                         \
-                stderr,                                                                      \
-                "Failed to parse float64 from configuration with key \"%s\", skipping...\n", \
-                key                                                                          \
-            );                                                                               \
-        } else {                                                                             \
-            var = value.u.fp64;                                                              \
-        }                                                                                    \
-    }
-
-void ProcessConfiguration(int argc, char **argv, Configuration *configuration) {
-    if (argc == 1) {
+int main(int argc, char **argv) {
+    Arguments arguments = {
+        .headless_options = DefaultHeadlessOptions(),
+        .script = { .ticks_per_move = SCRIPT_TICKS_PER_MOVE },
+        .hash_interval = REPLAY_DEFAULT_HASH_INTERVAL,
+        .rollback = DefaultRollbackOptions(),
+    };
+
+    if (!ParseArguments(argc, argv, &arguments)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    InstallAllocators();
+
+    Configuration config = DefaultConfiguration();
+
+    if (arguments.configuration_path) {
+        ProcessConfiguration(arguments.configuration_path, &config);
+    } else {
         printf("No configuration provided, using the default\n");
-        printf("Usage: %s <path_to_config.toml>\n", argv[0]);
-        return;
+        PrintUsage(argv[0]);
     }
 
-    FILE *config_file = fopen(argv[1], "r");
+    ApplyArgumentOverrides(&arguments, &config);
 
-    if (!config_file) {
-        fprintf(stderr, "Failed to open configuration file, skipping...\n");
-        return;
+    // NOTE: recordings only hold what the Box2D ball needs
+    if (arguments.record_path && config.ball_count > 0) {
+        fprintf(stderr, "Recording with a single ball, ignoring ball.count\n");
+        config.ball_count = 0;
     }
 
-    toml_result_t parse_result = toml_parse_file(config_file);
+    // NOTE: nor do they describe the brick field beyond bricks_in_row
+    if ((arguments.record_path || arguments.level_path)
+        && config.scroll_speed > 0) {
+        fprintf(stderr, "Not scrolling, ignoring game.scroll_speed\n");
+        config.scroll_speed = 0.0;
+    }
 
-    if (!parse_result.ok) {
+    // NOTE: a versus session plays a single ball on a fixed field
+    if (arguments.versus
+        && (config.ball_count > 0 || config.scroll_speed > 0)) {
         fprintf(
-            stderr,
-            "Failed to read configuration file with error:\n%s, skipping...\n",
-            parse_result.errmsg
+            stderr, "Versus match, ignoring ball.count and game.scroll_speed\n"
         );
+        config.ball_count = 0;
+        config.scroll_speed = 0.0;
+    }
 
-        fclose(config_file);
-        toml_free(parse_result);
-        return;
+    LevelFile level = { 0 };
+
+    if (arguments.level_path) {
+        if (!OpenLevel(&level, arguments.level_path)) {
+            return 1;
+        }
+        config.level = &level;
     }
 
-    TOML_GET_INT64(
-        parse_result.toptab, "game.bricks_in_row", configuration->bricks_in_row
-    );
-    TOML_GET_INT64(
-        parse_result.toptab, "player.width", configuration->player.width
-    );
-    TOML_GET_INT64(
-        parse_result.toptab, "player.height", configuration->player.height
-    );
-    TOML_GET_F64(
-        parse_result.toptab,
-        "player.movement_speed",
-        configuration->player.movement_speed
-    );
-    TOML_GET_F64(
-        parse_result.toptab, "ball.radius", configuration->ball.radius
-    );
-    TOML_GET_F64(
-        parse_result.toptab,
-        "ball.min_speed_multiplier",
-        configuration->ball.min_speed_multiplier
-    );
+    TaskScheduler *scheduler = NULL;
 
-    fclose(config_file);
-    toml_free(parse_result);
-}
+    // NOTE: a versus session steps both fields on the analytic physics, which
+    // has no use for workers
+    if (config.worker_count > 1 && !arguments.versus) {
+        scheduler = CreateTaskScheduler(config.worker_count);
+        config.scheduler = scheduler;
+    }
 
-int main(int argc, char **argv) {
-    b2WorldDef world_def = b2DefaultWorldDef();
-    world_def.gravity = b2Vec2_zero;
-    world_def.enableContinuous = true;
-    b2WorldId world_id = b2CreateWorld(&world_def);
-
-    Configuration config = {
-        .bricks_in_row = BRICKS_IN_ROW,
-        .rows_colors = {RED, ORANGE, YELLOW, GREEN, BLUE, PURPLE, PINK, MAROON},
-        .background_color = BLACK,
-        .player = {
-            .movement_speed = 400.f,
-            .width = 100,
-            .height = 15,
-            .color = DARKBLUE,
-        },
-        .ball = {
-            .color = WHITE,
-            .radius = 8.f,
-            .max_speed = PIXELS_TO_WORLD(400.f),
-            .min_speed_multiplier = 0.8f,
-            .initial_velocity = {PIXELS_TO_WORLD(150.f), PIXELS_TO_WORLD(300.f)},
-        },
-        .bricks = malloc(sizeof(Brick) * BRICKS_IN_ROW * ROWS_NUMBER),
-        .world_id = world_id
-    };
+    if (arguments.replay_path) {
+        Replay replay;
+
+        if (!LoadReplay(&replay, arguments.replay_path)) {
+            return 1;
+        }
+
+        ReplayReport report = RunReplay(&replay, &config);
+        PrintReplayReport(&report);
+        FreeReplay(&replay);
+
+        if (scheduler) {
+            DestroyTaskScheduler(scheduler);
+        }
+        return report.diverged_tick >= 0 ? 1 : 0;
+    }
+
+    NetTransport *transport = NULL;
+
+    if (arguments.versus) {
+        transport = OpenVersusTransport(&arguments);
+
+        if (!transport) {
+            CloseLevel(&level);
+            return 1;
+        }
+
+        arguments.rollback.local_player = (int)arguments.versus - 1;
+        arguments.rollback.max_ticks =
+            arguments.headless ? arguments.headless_options.max_ticks : 0;
+    }
+
+    if (arguments.versus && arguments.headless) {
+        RollbackStats stats = RunHeadlessVersus(
+            &config, &arguments.headless_options, &arguments.rollback, transport
+        );
+        PrintRollbackStats(&stats);
+
+        CloseNetTransport(transport);
+        CloseLevel(&level);
+        return stats.desync_tick >= 0 || stats.outcome == ROLLBACK_DISCONNECTED
+                 ? 1
+                 : 0;
+    }
+
+    Telemetry *telemetry = NULL;
+
+    if (arguments.telemetry_path) {
+        telemetry = StartTelemetry(arguments.telemetry_path, config.tick_rate);
+
+        if (!telemetry) {
+            return 1;
+        }
+        config.telemetry = telemetry;
+    }
+
+    Replay recording;
+
+    if (arguments.record_path) {
+        BeginRecording(&recording, &config, arguments.hash_interval);
+        config.recorder = &recording;
+    }
 
-    ProcessConfiguration(argc, argv, &config);
+    if (arguments.compare_physics) {
+        const PhysicsBackend *candidate = config.physics != &BOX2D_PHYSICS
+                                            ? config.physics
+                                            : &ANALYTIC_PHYSICS;
+
+        for (int kind = 0; kind < PHYSICS_KIND_COUNT; kind++) {
+            config.physics = GetPhysicsBackend(kind);
+
+            HeadlessReport report =
+                RunHeadless(&config, &arguments.headless_options);
+            PrintHeadlessReport(&report);
+            printf("\n");
+        }
+
+        PhysicsComparison comparison = ComparePhysics(
+            &config, &arguments.headless_options, candidate
+        );
+        bool consistent = PrintPhysicsComparison(&comparison);
+
+        StopTelemetry(telemetry);
+        CloseLevel(&level);
+
+        if (scheduler) {
+            DestroyTaskScheduler(scheduler);
+        }
+        return consistent ? 0 : 1;
+    }
 
-    CreatePlayer(&config);
-    CreateBall(&config);
-    CreateWalls(&config);
-    CreateBricks(&config);
+    if (arguments.headless) {
+        if (arguments.compare_workers) {
+            config.scheduler = NULL;
+            config.recorder = NULL;
+
+            HeadlessReport report =
+                RunHeadless(&config, &arguments.headless_options);
+            PrintHeadlessReport(&report);
+            printf("\n");
+
+            config.scheduler = scheduler;
+            config.recorder = arguments.record_path ? &recording : NULL;
+        }
+
+        HeadlessReport report =
+            RunHeadless(&config, &arguments.headless_options);
+        PrintHeadlessReport(&report);
+
+        if (config.recorder) {
+            SaveReplay(&recording, arguments.record_path);
+            FreeReplay(&recording);
+        }
+
+        StopTelemetry(telemetry);
+        CloseLevel(&level);
+
+        if (scheduler) {
+            DestroyTaskScheduler(scheduler);
+        }
+        return 0;
+    }
+
+    RollbackSession *versus = NULL;
+    Configuration   *game = &config;
+
+    if (transport) {
+        versus = CreateRollbackSession(&config, &arguments.rollback, transport);
+        game =
+            GetRollbackConfiguration(versus, arguments.rollback.local_player);
+    } else {
+        InitGame(&config);
+    }
 
     SetTraceLogLevel(LOG_WARNING);
 
     InitWindow(WIDTH, HEIGHT, "Breakout");
     SetTargetFPS(60);
 
-    b2Body_SetLinearVelocity(config.ball.body_id, config.ball.initial_velocity);
+    BrickLayer brick_layer = CreateBrickLayer();
+
+    // NOTE: each thread times its own phases into its own profiler, the
+    // overlay shows the tick phases of one and the frame phases of the other
+    Profiler     simulation_profiler = { 0 };
+    Profiler     render_profiler = { 0 };
+    Profiler    *frame_profiler = NULL;
+    ProfileStats profile_stats[PROFILE_PHASE_COUNT] = { 0 };
+    bool         show_profile = false;
+    MemoryStats  memory_stats[MEMORY_SUBSYSTEM_COUNT] = { 0 };
+    long         frame_allocations = 0;
+    long         allocation_count = GetTotalAllocationCount();
+
+    if (arguments.profile) {
+        CreateProfiler(&simulation_profiler, PROFILER_DEFAULT_CAPACITY);
+        CreateProfiler(&render_profiler, PROFILER_DEFAULT_CAPACITY);
+        config.profiler = &simulation_profiler;
+        frame_profiler = &render_profiler;
+    }
+
+    static Simulation simulation;
+    simulation.config = game;
+    simulation.clock = CreateGameClock(game);
+    simulation.layout_version = 1;
+    simulation.versus = versus;
+
+    // NOTE: the match cannot be rewound, the peer has played on
+    if (!versus && CanRewind(&config)) {
+        CreateSnapshotRing(
+            &simulation.rewind, &config, SNAPSHOT_DEFAULT_RING_CAPACITY
+        );
+    }
+
+    // NOTE: a reload mid recording would not be reproduced by the replay
+    if (arguments.watch && !config.recorder) {
+        simulation.watcher = StartConfigWatcher(arguments.configuration_path);
+        simulation.arguments = &arguments;
+    }
+
+    CreateRenderStateBuffer(&simulation.render_states);
+    CreateSpscRing(
+        &simulation.inputs, sizeof(FrameInput), INPUT_QUEUE_CAPACITY
+    );
+    atomic_init(&simulation.running, true);
+
+    // NOTE: the renderer has a state to draw before the first tick
+    PublishSimulation(&simulation);
+
+    thrd_t simulation_thread;
+
+    if (thrd_create(&simulation_thread, SimulationMain, &simulation)
+        != thrd_success) {
+        fprintf(stderr, "Failed to start the simulation thread\n");
+        return 1;
+    }
 
     while (!WindowShouldClose()) {
-        ProcessInput(&config);
+        BeginProfilerFrame(frame_profiler);
 
-        CheckBallBrickCollisions(&config);
+        FrameInput frame_input = {
+            .input = SampleKeyboardInput(),
+            .rewind = IsKeyDown(KEY_R),
+        };
 
-        double frame_time = GetFrameTime();
-        int    steps = (int)(frame_time / (1.0f / 120.0f)) + 1;
-        double time_step = frame_time / steps;
+        // NOTE: the queue only fills up if the simulation stalls, the frame's
+        // input is dropped then
+        PushSpscRing(&simulation.inputs, &frame_input);
 
-        for (int i = 0; i < steps; i++) {
-            b2World_Step(config.world_id, time_step, 8);
+        if (frame_profiler && IsKeyPressed(KEY_F3)) {
+            show_profile = !show_profile;
         }
 
-        ClampPlayerMovement(&config.player);
-        ClampBallMovement(&config);
+        const RenderState *state =
+            AcquireRenderState(&simulation.render_states);
 
-        b2Vec2 bp = b2Body_GetPosition(config.ball.body_id);
+        // NOTE: the next tick is due one time step after the state was taken
+        double alpha = (GetClockNanoseconds() - state->captured_at) * 1e-9
+                     / state->time_step;
+        alpha = alpha < 1.0 ? alpha : 1.0;
 
-        if (bp.y >= PIXELS_TO_WORLD(HEIGHT)) {
-            b2Vec2 restart_position =
-                (b2Vec2){ PIXELS_TO_WORLD((double)WIDTH / 2),
-                          PIXELS_TO_WORLD(HEIGHT - (double)HEIGHT / 2) };
-            b2Body_SetTransform(
-                config.ball.body_id, restart_position, b2Rot_identity
-            );
-            b2Body_SetLinearVelocity(
-                config.ball.body_id, config.ball.initial_velocity
-            );
-        }
+        uint64_t sample = BeginProfileSample(frame_profiler);
 
         BeginDrawing();
-        ClearBackground(config.background_color);
+        ClearBackground(state->background_color);
+
+        DrawBricks(&brick_layer, state);
+        DrawPlayer(state, alpha);
+        DrawBall(state, alpha);
+        DrawSwarm(state, alpha);
+        DrawScore(state);
+
+        EndProfileSample(frame_profiler, PROFILE_PHASE_DRAW, sample);
+
+        if (show_profile) {
+            if (render_profiler.frame % PROFILER_OVERLAY_REFRESH_FRAMES == 0) {
+                for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+                    profile_stats[phase] =
+                        IsRenderPhase(phase)
+                            ? GetProfileStats(&render_profiler, phase)
+                            : state->profile_stats[phase];
+                }
 
-        DrawBricks(&config);
-        DrawPlayer(&config);
-        DrawBall(&config);
+                for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+                    memory_stats[i] = GetMemoryStats(i);
+                }
+            }
+
+            DrawProfilerOverlay(
+                profile_stats, memory_stats, frame_allocations
+            );
+        }
 
 #ifdef DEBUGGING
-        b2Vec2 ball_vel = b2Body_GetLinearVelocity(config.ball.body_id);
-        double screen_x = WORLD_TO_PIXELS(bp.x);
-        double screen_y = WORLD_TO_PIXELS(bp.y);
+        b2Vec2 ball_vel = state->ball_velocity;
+        double screen_x = state->ball_position.x;
+        double screen_y = state->ball_position.y;
 
         DrawLine(
             screen_x,
@@ -541,12 +1227,62 @@ int main(int argc, char **argv) {
         );
 #endif
 
+        // NOTE: includes the wait for the target frame rate
+        sample = BeginProfileSample(frame_profiler);
         EndDrawing();
+        EndProfileSample(frame_profiler, PROFILE_PHASE_PRESENT, sample);
+
+        EndProfilerFrame(frame_profiler);
+
+        // NOTE: a steady state frame should not allocate at all, this counts
+        // the simulation's allocations during the frame too
+        long total_allocations = GetTotalAllocationCount();
+        frame_allocations = total_allocations - allocation_count;
+        allocation_count = total_allocations;
     }
 
-    DestroyAllBricks(&config);
-    b2DestroyWorld(world_id);
-    free(config.bricks);
+    atomic_store(&simulation.running, false);
+    thrd_join(simulation_thread, NULL);
+
+    if (config.profiler) {
+        if (arguments.profile_path) {
+            WriteProfilerCsv(&simulation_profiler, arguments.profile_path);
+            WriteProfilerCsv(
+                &render_profiler, GetRenderCsvPath(arguments.profile_path)
+            );
+        }
+        FreeProfiler(&simulation_profiler);
+        FreeProfiler(&render_profiler);
+        config.profiler = NULL;
+    }
+
+    if (simulation.watcher) {
+        StopConfigWatcher(simulation.watcher);
+    }
+
+    FreeSnapshotRing(&simulation.rewind);
+    FreeSpscRing(&simulation.inputs);
+    FreeRenderStateBuffer(&simulation.render_states);
+    UnloadBrickLayer(&brick_layer);
+
+    if (versus) {
+        DestroyRollbackSession(versus);
+        CloseNetTransport(transport);
+    } else {
+        ShutdownGame(&config);
+    }
     CloseWindow();
+
+    if (config.recorder) {
+        SaveReplay(&recording, arguments.record_path);
+        FreeReplay(&recording);
+    }
+
+    StopTelemetry(telemetry);
+    CloseLevel(&level);
+
+    if (scheduler) {
+        DestroyTaskScheduler(scheduler);
+    }
     return 0;
 }
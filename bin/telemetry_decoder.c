@@ -0,0 +1,32 @@
+#include <stdio.h>
+#include <breakout/telemetry.h>
+
+int main(int argc, char **argv) {
+    if (argc != 2 && argc != 3) {
+        printf("Usage: %s <session.bktl> [events.csv]\n", argv[0]);
+        printf("Writes the events of a telemetry log as CSV, to stdout when\n");
+        printf("no file is given\n");
+        return 1;
+    }
+
+    FILE *csv = stdout;
+
+    if (argc == 3) {
+        csv = fopen(argv[2], "w");
+
+        if (!csv) {
+            fprintf(stderr, "Failed to open \"%s\" for writing\n", argv[2]);
+            return 1;
+        }
+    }
+
+    long event_count;
+    bool ok = DecodeTelemetryLog(argv[1], csv, &event_count);
+
+    if (csv != stdout) {
+        fclose(csv);
+        printf("Decoded %ld events into \"%s\"\n", event_count, argv[2]);
+    }
+
+    return ok ? 0 : 1;
+}
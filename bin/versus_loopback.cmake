@@ -0,0 +1,38 @@
+# Plays a headless versus match between two processes on loopback, both
+# sending with latency and loss. Fails if either one reports a desync or stops
+# hearing from the other, it exits with 1 then.
+#
+#     cmake -DBREAKOUT=<breakout> -DCONFIGURATION=<toml> -P versus_loopback.cmake
+
+# NOTE: ports next to the default ones, a match played on the same machine
+# while the tests run does not get in the way
+set(FIRST_PORT 17777)
+set(SECOND_PORT 17778)
+set(OPTIONS --headless --ticks 600 --latency 40 --loss 10)
+
+# NOTE: commands of a pipeline run at the same time. Player 1's report goes
+# into player 2's stdin, which is never read, so only its exit code is seen
+execute_process(
+    COMMAND ${BREAKOUT} --versus 1 ${OPTIONS}
+            --port ${FIRST_PORT} --peer 127.0.0.1:${SECOND_PORT}
+            ${CONFIGURATION}
+    COMMAND ${BREAKOUT} --versus 2 ${OPTIONS}
+            --port ${SECOND_PORT} --peer 127.0.0.1:${FIRST_PORT}
+            ${CONFIGURATION}
+    RESULTS_VARIABLE results
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE errors
+    TIMEOUT 60
+)
+
+message("${output}")
+
+if (NOT results STREQUAL "0;0")
+    message(FATAL_ERROR "Versus players exited with ${results}\n${errors}")
+endif()
+
+string(FIND "${output}" "Desync at tick:   none" desync)
+
+if (desync EQUAL -1)
+    message(FATAL_ERROR "Player 2 reported a desync")
+endif()
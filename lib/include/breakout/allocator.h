@@ -0,0 +1,74 @@
+#ifndef BREAKOUT_ALLOCATOR_H
+#define BREAKOUT_ALLOCATOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+// NOTE: pools hold blocks of 32, 64, 128 and 256 bytes, header included
+#define MEMORY_POOL_COUNT    4
+#define MEMORY_POOL_MAX_SIZE 256
+
+typedef enum MemorySubsystem {
+    MEMORY_GAME,
+    // NOTE: everything that lives as long as a level, served by its arena
+    MEMORY_LEVEL,
+    MEMORY_BOX2D,
+    MEMORY_TOML,
+    MEMORY_SUBSYSTEM_COUNT,
+} MemorySubsystem;
+
+typedef struct MemoryStats {
+    size_t bytes_in_use;
+    size_t peak_bytes;
+    long   allocation_count;
+} MemoryStats;
+
+/*
+ * Every heap allocation of the game goes through here and is counted per
+ * subsystem. Blocks of up to MEMORY_POOL_MAX_SIZE bytes come from fixed size
+ * pools that keep freed blocks for reuse, larger ones from malloc. Safe to
+ * call from any thread.
+ */
+void *MemoryAlloc(MemorySubsystem subsystem, size_t size);
+void *MemoryCalloc(MemorySubsystem subsystem, size_t count, size_t size);
+/* subsystem is only used when memory is NULL, a block keeps its own */
+void *MemoryRealloc(MemorySubsystem subsystem, void *memory, size_t size);
+/* Accepts NULL, the subsystem is remembered by the block */
+void  MemoryFree(void *memory);
+
+/* Routes Box2D and tomlc17 through MemoryAlloc, call before creating a world
+ * or parsing anything */
+void InstallAllocators(void);
+
+MemoryStats GetMemoryStats(MemorySubsystem subsystem);
+const char *GetMemorySubsystemName(MemorySubsystem subsystem);
+/* Over all subsystems, the difference between two frames is the number of
+ * allocations the frame made */
+long GetTotalAllocationCount(void);
+
+typedef struct ArenaBlock ArenaBlock;
+
+/*
+ * Bump allocator for data that is released all at once. Blocks are kept on
+ * reset and reused by the next level, only FreeArena returns them.
+ */
+typedef struct Arena {
+    ArenaBlock *first;
+    ArenaBlock *current;
+    size_t      block_size;
+    size_t      used;
+} Arena;
+
+void  InitArena(Arena *arena, size_t block_size);
+/* Zeroed memory, valid until the next reset */
+void *ArenaAlloc(Arena *arena, size_t size, size_t alignment);
+void  ResetArena(Arena *arena);
+void  FreeArena(Arena *arena);
+
+#define ARENA_ALLOC_ARRAY(arena, type, count) \
+    ((type *)ArenaAlloc((arena), sizeof(type) * (size_t)(count), _Alignof(type)))
+
+#endif // BREAKOUT_ALLOCATOR_H
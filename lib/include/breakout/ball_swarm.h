@@ -0,0 +1,78 @@
+#ifndef BREAKOUT_BALL_SWARM_H
+#define BREAKOUT_BALL_SWARM_H
+
+#include <raylib.h>
+#include <stdint.h>
+
+// NOTE: arrays are padded to a multiple of the widest kernel, so kernels run
+// over whole vectors and never need a scalar tail
+#define BALL_SWARM_PADDING 8
+
+// NOTE: most rectangles a single circle test gets, a 2x2 cell query over a
+// generated layout gathers at most 4
+#define BALL_SWARM_MAX_RECTANGLES 32
+
+// NOTE: 0.1 m/s, below it a ball counts as resting like in ClampBallMovement
+#define BALL_SWARM_REST_SPEED 5.f
+
+/*
+ * Balls of multi-ball mode as a structure of arrays, in pixels and pixels per
+ * second. They are moved by the kernels below instead of Box2D, so thousands
+ * of them cost a few passes over flat float arrays per tick. All kernels run
+ * over count balls, 8 at a time with AVX, 4 with SSE and one by one when the
+ * compiler targets neither.
+ */
+typedef struct BallSwarm {
+    float *position_x;
+    float *position_y;
+    float *velocity_x;
+    float *velocity_y;
+    // NOTE: positions of the previous tick, for interpolated drawing
+    float *previous_x;
+    float *previous_y;
+    // NOTE: output of SelectBallsBetween
+    int   *selected;
+    int    count;
+    int    capacity;
+} BallSwarm;
+
+void CreateBallSwarm(BallSwarm *swarm, int count);
+void FreeBallSwarm(BallSwarm *swarm);
+
+/* "avx", "sse" or "scalar", whichever the kernels were built for */
+const char *GetBallKernelName(void);
+
+/* Moves every ball by its velocity and bounces it off the left, right and top
+ * edges of a field width pixels wide */
+void MoveBalls(BallSwarm *swarm, float time_step, float radius, float width);
+
+/* Same rules as ClampBallMovement: faster than max_speed is slowed down to it,
+ * slower than half of it is sped up to max_speed * min_speed_multiplier */
+void ClampBallSpeeds(
+    BallSwarm *swarm, float max_speed, float min_speed_multiplier
+);
+
+/* Sends every ball overlapping rectangle (a paddle) upwards */
+void BounceBallsOffRectangle(
+    BallSwarm *swarm, float radius, Rectangle rectangle
+);
+
+/* Writes the indices of the balls with min_y <= y < max_y to
+ * swarm->selected, in order, and returns how many there are */
+int SelectBallsBetween(BallSwarm *swarm, float min_y, float max_y);
+
+/* Tests one circle against count rectangles given as edge arrays, bit i of the
+ * result is set if rectangle i overlaps it. count is at most
+ * BALL_SWARM_MAX_RECTANGLES and the arrays are padded like the swarm's */
+uint32_t TestCircleRectangles(
+    float        x,
+    float        y,
+    float        radius,
+    const float *left,
+    const float *top,
+    const float *right,
+    const float *bottom,
+    int          count
+);
+
+#endif // BREAKOUT_BALL_SWARM_H
@@ -0,0 +1,57 @@
+#ifndef BREAKOUT_BRICK_GRID_H
+#define BREAKOUT_BRICK_GRID_H
+
+#include <raylib.h>
+#include <breakout/allocator.h>
+
+// NOTE: about 16 MB of cell offsets, far apart bricks get bigger cells
+#define BRICK_GRID_MAX_CELLS (1 << 22)
+
+/*
+ * Uniform grid over the brick field in pixel space. Every cell lists the
+ * bricks overlapping it (cell_bricks[cell_start[c] .. cell_start[c + 1]]), so
+ * a query only visits the cells under the queried rectangle instead of the
+ * whole field. row_live counts live bricks per grid row to skip cleared rows.
+ */
+typedef struct BrickGrid {
+    Vector2 origin;
+    Vector2 cell_size;
+    int     columns;
+    int     rows;
+    int    *cell_start;
+    int    *cell_bricks;
+    int    *row_live;
+} BrickGrid;
+
+/* Brick i is a sizes[i] rectangle at positions[i] (its top left corner), the
+ * grid lives in arena. cell_size is doubled until the grid has at most
+ * BRICK_GRID_MAX_CELLS cells */
+void BuildBrickGrid(
+    BrickGrid     *grid,
+    const Vector2 *positions,
+    const Vector2 *sizes,
+    int            count,
+    Vector2        cell_size,
+    Arena         *arena
+);
+
+/* Cell range covered by area, returns false if it misses the grid */
+bool GetBrickGridCells(
+    const BrickGrid *grid,
+    Rectangle        area,
+    int             *first_column,
+    int             *first_row,
+    int             *last_column,
+    int             *last_row
+);
+
+/* Updates the live counts of the rows a removed brick overlapped */
+void RemoveBrickFromGrid(
+    BrickGrid *grid, Vector2 position, Vector2 brick_size
+);
+/* Reverse of RemoveBrickFromGrid for a brick that was brought back */
+void RestoreBrickInGrid(
+    BrickGrid *grid, Vector2 position, Vector2 brick_size
+);
+
+#endif // BREAKOUT_BRICK_GRID_H
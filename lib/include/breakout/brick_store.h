@@ -0,0 +1,64 @@
+#ifndef BREAKOUT_BRICK_STORE_H
+#define BREAKOUT_BRICK_STORE_H
+
+#include <raylib.h>
+#include <box2d/box2d.h>
+#include <breakout/allocator.h>
+#include <stdint.h>
+
+#define BRICK_STORE_WORD_BITS 64
+
+// NOTE: bricks sharing one static body, a chunk of consecutive indices is a
+// few rows of the grid layout
+#define BRICK_STORE_CHUNK_SIZE 1024
+
+/*
+ * Bricks stored as parallel arrays indexed by brick, with a packed bitset of
+ * the ones still alive. Hot loops only touch the arrays they need and skip
+ * destroyed bricks a whole word at a time. Every brick is a shape on the
+ * static body of its chunk, hitting a brick only destroys its shape.
+ */
+typedef struct BrickStore {
+    int       count;
+    int       word_count;
+    Vector2  *positions;
+    Vector2  *sizes;
+    Color    *colors;
+    // NOTE: hits left before the brick is destroyed
+    uint8_t  *hit_points;
+    b2ShapeId *shape_ids;
+    b2BodyId *chunk_body_ids;
+    int       chunk_count;
+    // NOTE: bricks per chunk body, BRICK_STORE_CHUNK_SIZE unless the chunks
+    // have to move on their own
+    int       chunk_size;
+    uint64_t *live;
+    int      *destroy_queue;
+    int       destroy_count;
+} BrickStore;
+
+/* The arrays live in arena and go away with it */
+void CreateBrickStore(
+    BrickStore *store, int count, int chunk_size, Arena *arena
+);
+
+static inline bool IsBrickLive(const BrickStore *store, int index) {
+    return (store->live[index / BRICK_STORE_WORD_BITS]
+            >> (index % BRICK_STORE_WORD_BITS))
+         & 1;
+}
+
+void SetBrickLive(BrickStore *store, int index, bool live);
+
+/* Index of the first live brick at or after from, -1 if there is none. Walk
+ * every live brick with:
+ *     for (int i = NextLiveBrick(s, 0); i >= 0; i = NextLiveBrick(s, i + 1)) */
+int NextLiveBrick(const BrickStore *store, int from);
+
+int CountLiveBricks(const BrickStore *store);
+
+/* Clears the live bit and queues the brick for destruction, a brick that is
+ * already dead is ignored so repeated hits in one tick are only queued once */
+void QueueBrickDestruction(BrickStore *store, int index);
+
+#endif // BREAKOUT_BRICK_STORE_H
@@ -0,0 +1,10 @@
+#ifndef BREAKOUT_CLOCK_H
+#define BREAKOUT_CLOCK_H
+
+#include <stdint.h>
+
+/* Monotonic time, does not need a raylib window unlike GetTime() */
+uint64_t GetClockNanoseconds(void);
+double   GetClockSeconds(void);
+
+#endif // BREAKOUT_CLOCK_H
@@ -0,0 +1,24 @@
+#ifndef BREAKOUT_CONFIG_WATCHER_H
+#define BREAKOUT_CONFIG_WATCHER_H
+
+#include <breakout/game.h>
+
+/*
+ * Watches a configuration file on a background thread (inotify on Linux,
+ * polling the modification time elsewhere) and re-parses it whenever it is
+ * written. The parsed configuration is published through an atomic pointer,
+ * the game loop takes it between ticks and applies it with
+ * ApplyConfiguration. A newer reload replaces one that was not taken yet.
+ */
+typedef struct ConfigWatcher ConfigWatcher;
+
+/* Returns NULL if the file cannot be watched */
+ConfigWatcher *StartConfigWatcher(const char *path);
+void           StopConfigWatcher(ConfigWatcher *watcher);
+
+/* Latest reloaded configuration or NULL, owned by the caller who releases it
+ * with FreeReloadedConfiguration */
+Configuration *TakeReloadedConfiguration(ConfigWatcher *watcher);
+void           FreeReloadedConfiguration(Configuration *config);
+
+#endif // BREAKOUT_CONFIG_WATCHER_H
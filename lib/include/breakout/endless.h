@@ -0,0 +1,54 @@
+#ifndef BREAKOUT_ENDLESS_H
+#define BREAKOUT_ENDLESS_H
+
+#include <stdint.h>
+
+#define ENDLESS_DEFAULT_SCROLL_SPEED 20.0
+
+// NOTE: out of 256, the chance that a generated slot holds a brick
+#define ENDLESS_BRICK_CHANCE 208
+
+// NOTE: deeper rows take more hits, one more every this many rows
+#define ENDLESS_ROWS_PER_HIT_POINT 64
+#define ENDLESS_MAX_HIT_POINTS     3
+
+typedef struct Configuration Configuration;
+
+/*
+ * Brick field of endless mode, a fixed pool of rows that covers the screen
+ * with one row to spare above it. Every row is a kinematic chunk body moving
+ * down at scroll_speed with its bricks as shapes, the row that leaves the
+ * bottom is moved above the top one and filled with a newly generated row.
+ * Hit bricks keep their shape with a filter that collides with nothing, so
+ * nothing is created or destroyed once the pool is set up.
+ */
+typedef struct EndlessField {
+    // NOTE: 0 when endless mode is off
+    int      row_count;
+    // NOTE: pool slot of the highest row, the next slots are the rows below
+    int      top_row;
+    float    row_pitch;
+    // NOTE: top edge of every pool row in pixels, follows its body
+    float   *row_y;
+    uint32_t generated_rows;
+    long     destroyed_count;
+} EndlessField;
+
+/* Rows in the pool for the configured brick size, sets the brick dimensions */
+int GetEndlessRowCount(Configuration *config);
+
+/* Fills the brick store, sized for GetEndlessRowCount rows, with the pool.
+ * The bottom row starts where the bottom row of the fixed field is */
+void CreateEndlessBricks(Configuration *config);
+
+/* Runs after the world step, refreshes the brick positions from the row
+ * bodies and recycles the rows that left the screen */
+void ScrollEndlessBricks(Configuration *config);
+
+/* Takes a hit brick out of play and counts it, its shape stays in the pool */
+void RetireEndlessBrick(Configuration *config, int brick_index);
+
+/* Applies a new scroll_speed to the rows */
+void SetEndlessScrollSpeed(Configuration *config);
+
+#endif // BREAKOUT_ENDLESS_H
@@ -0,0 +1,20 @@
+#ifndef BREAKOUT_FILE_MAP_H
+#define BREAKOUT_FILE_MAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Read only view of a whole file, pages are loaded on first access */
+typedef struct FileMap {
+    const void *data;
+    size_t      size;
+#ifdef _WIN32
+    void       *file;
+    void       *mapping;
+#endif
+} FileMap;
+
+bool MapFile(FileMap *map, const char *path);
+void UnmapFile(FileMap *map);
+
+#endif // BREAKOUT_FILE_MAP_H
@@ -0,0 +1,218 @@
+#ifndef BREAKOUT_GAME_H
+#define BREAKOUT_GAME_H
+
+#include <raylib.h>
+#include <box2d/box2d.h>
+#include <breakout/allocator.h>
+#include <breakout/ball_swarm.h>
+#include <breakout/brick_grid.h>
+#include <breakout/brick_store.h>
+#include <breakout/endless.h>
+#include <breakout/level.h>
+#include <breakout/physics.h>
+#include <breakout/profiler.h>
+#include <breakout/replay.h>
+#include <breakout/task_scheduler.h>
+#include <breakout/telemetry.h>
+
+#define WIDTH  1280
+#define HEIGHT 720
+
+#define ROWS_NUMBER        8
+#define BRICKS_PADDING     15.f
+#define BRICKS_MARGIN      10.f
+#define BRICKS_AREA_HEIGHT 300.f
+#define BRICKS_IN_ROW 8
+
+#define WALLS_WIDTH 10.f
+
+#define PHYSICS_SUBSTEP_COUNT 8
+
+#define DEFAULT_TICK_RATE       120
+#define DEFAULT_MAX_FRAME_TICKS 8
+#define DEFAULT_WORKER_COUNT    1
+
+#define BALL_COLLISION_DISTANCE 3.f
+
+// NOTE: the paddle sends the ball off faster than it came, clamping takes the
+// extra speed back
+#define PLAYER_RESTITUTION 1.2f
+
+#define PIXELS_PER_METER 50.0f
+#define METERS_PER_PIXEL (1.0f / PIXELS_PER_METER)
+
+#define WORLD_TO_PIXELS(x) ((x) * PIXELS_PER_METER)
+#define PIXELS_TO_WORLD(x) ((x) * METERS_PER_PIXEL)
+
+typedef struct Ball {
+    Color    color;
+    double   radius;
+    double   max_speed;
+    double   min_speed_multiplier;
+    b2Vec2   initial_velocity;
+    b2Vec2   previous_position;
+    b2BodyId body_id;
+} Ball;
+
+typedef struct Player {
+    double    movement_speed;
+    double    width;
+    double    height;
+    Color     color;
+    b2Vec2    previous_position;
+    b2BodyId  body_id;
+    b2Polygon collider;
+} Player;
+
+typedef struct Configuration {
+    long        bricks_in_row;
+    long        tick_rate;
+    long        max_frame_ticks;
+    long        worker_count;
+    // NOTE: balls of multi-ball mode on top of the physics ball, 0 plays with
+    // that one only
+    long        ball_count;
+    // NOTE: pixels per second the brick field scrolls down in endless mode,
+    // 0 keeps the fixed field
+    double      scroll_speed;
+    double      brick_width;
+    double      brick_height;
+    double      brick_padding;
+    Color       background_color;
+    const Color rows_colors[ROWS_NUMBER];
+    Player      player;
+    Ball        ball;
+    BallSwarm   swarm;
+    BrickStore  bricks;
+    BrickGrid   brick_grid;
+    EndlessField endless;
+    // NOTE: holds the brick store and grid, set up by InitGame
+    Arena       level_arena;
+    const PhysicsBackend *physics;
+    // NOTE: world of the Box2D backend, null with the analytic one
+    b2WorldId   world_id;
+    AnalyticWorld analytic;
+    PhysicsHits hits;
+    // NOTE: not owned, when set the world steps on its worker_count threads
+    TaskScheduler *scheduler;
+    // NOTE: not owned, when set every tick is appended to it
+    Replay        *recorder;
+    // NOTE: not owned, when set the tick phases are timed into it
+    Profiler      *profiler;
+    // NOTE: not owned, when set gameplay events are logged into it
+    Telemetry     *telemetry;
+    // NOTE: not owned, when set the bricks come from it instead of the grid
+    // laid out from bricks_in_row
+    const LevelFile *level;
+} Configuration;
+
+/*
+ * Accumulates real frame time and turns it into whole fixed ticks, the
+ * remainder is used to interpolate rendering between the last two ticks
+ */
+typedef struct GameClock {
+    double time_step;
+    double accumulator;
+    long   max_frame_ticks;
+} GameClock;
+
+/*
+ * Paddle intent for a single tick. The windowed build fills it from the
+ * keyboard, headless runs fill it from a scripted source.
+ */
+typedef struct GameInput {
+    bool move_left;
+    bool move_right;
+    bool reset_ball;
+} GameInput;
+
+/* Produces the paddle input for a tick, replaces the keyboard when there is
+ * no window */
+typedef GameInput (*InputSource)(
+    const Configuration *config, long tick, void *user_data
+);
+
+Configuration DefaultConfiguration(void);
+
+/* Returns false if the file could not be read, the configuration is left
+ * untouched in that case */
+bool ProcessConfiguration(const char *path, Configuration *configuration);
+
+/* Creates the physics world and every body of the level, the brick store is
+ * sized from the configuration */
+void InitGame(Configuration *config);
+void ShutdownGame(Configuration *config);
+
+/*
+ * Applies a reloaded configuration to a running game between ticks. Paddle
+ * and ball shapes are resized in place and the brick field is rebuilt only if
+ * its layout changed or endless mode was turned on or off, the bodies keep
+ * their state. worker_count and physics need a new world and are not
+ * applied. Returns true if the brick field was rebuilt.
+ */
+bool ApplyConfiguration(Configuration *config, const Configuration *reloaded);
+
+void ProcessInput(Configuration *config, const GameInput *input);
+void CalculateBrickDimensions(Configuration *config);
+void ClampPlayerMovement(Configuration *config);
+void ClampBallMovement(Configuration *config);
+void ResetBall(Configuration *config);
+
+/* Where the ball and the paddle start, in meters */
+b2Vec2 GetBallStartPosition(void);
+b2Vec2 GetPlayerStartPosition(void);
+
+/* Ball and paddle state in meters, from the configured physics backend */
+static inline b2Vec2 GetBallPosition(const Configuration *config) {
+    return config->physics->get_ball_position(config);
+}
+
+static inline b2Vec2 GetBallVelocity(const Configuration *config) {
+    return config->physics->get_ball_velocity(config);
+}
+
+static inline b2Vec2 GetPlayerPosition(const Configuration *config) {
+    return config->physics->get_player_position(config);
+}
+
+void CreateBricks(Configuration *config);
+/* Creates ball_count swarm balls, all launched from the ball's start */
+void CreateSwarmBalls(Configuration *config);
+/* Puts a swarm ball back at the start, balls leave at angles spread around
+ * the initial velocity so they do not move as one */
+void ResetSwarmBall(Configuration *config, int ball_index);
+
+/* Marks a brick live and adds its collision, from its stored position and
+ * size, to the physics */
+void SpawnBrick(Configuration *config, int brick_index);
+/* Removes the collision of a brick and takes it out of the live set and grid,
+ * in endless mode the shape is kept for the next row */
+void DestroyBrick(Configuration *config, int brick_index);
+
+/* Destroys, in one batch, every brick that began touching the ball during the
+ * last physics step, paddle hits are logged to the telemetry */
+void CheckBallBrickCollisions(Configuration *config);
+void DestroyAllBricks(Configuration *config);
+
+/* Moves the swarm one tick: walls, paddle, bricks (hits count like the physics
+ * ball's), speed clamping and the reset of balls that fell out */
+void TickBallSwarm(Configuration *config);
+
+/* Runs a single fixed tick of 1 / tick_rate seconds: input, physics step,
+ * destruction of the bricks hit during the step, clamping and the out of
+ * bounds reset. Returns true if the ball was lost during this tick */
+bool TickGame(Configuration *config, const GameInput *input);
+
+GameClock CreateGameClock(const Configuration *config);
+
+/* Feeds frame_time into the clock and runs as many fixed ticks as fit, at most
+ * max_frame_ticks, so a long hitch drops time instead of spiraling. Returns
+ * the number of ticks run */
+int AdvanceGame(
+    Configuration   *config,
+    GameClock       *clock,
+    const GameInput *input,
+    double           frame_time
+);
+
+#endif // BREAKOUT_GAME_H
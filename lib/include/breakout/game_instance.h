@@ -0,0 +1,40 @@
+#ifndef BREAKOUT_GAME_INSTANCE_H
+#define BREAKOUT_GAME_INSTANCE_H
+
+#include <breakout/game.h>
+#include <stdint.h>
+
+typedef struct GameState {
+    long tick;
+    int  score;
+    int  bricks_left;
+    int  balls_lost;
+    bool cleared;
+} GameState;
+
+/*
+ * Self contained game with its own copy of the configuration and its own
+ * physics world, independent instances can be stepped from different threads.
+ */
+typedef struct GameInstance GameInstance;
+
+/* seed picks the initial ball direction, 0 keeps the configured velocity. The
+ * scheduler, recorder, profiler and telemetry of the configuration are not
+ * inherited, every instance steps its world on the calling thread */
+GameInstance *CreateGameInstance(const Configuration *config, uint32_t seed);
+void          DestroyGameInstance(GameInstance *instance);
+
+/* Runs up to ticks ticks, stops early once the level is cleared. Returns the
+ * number of ticks run */
+long StepGameInstance(
+    GameInstance *instance,
+    long          ticks,
+    InputSource   input_source,
+    void         *input_user_data
+);
+
+GameState GetGameState(const GameInstance *instance);
+
+const Configuration *GetGameConfiguration(const GameInstance *instance);
+
+#endif // BREAKOUT_GAME_INSTANCE_H
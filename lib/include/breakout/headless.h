@@ -0,0 +1,116 @@
+#ifndef BREAKOUT_HEADLESS_H
+#define BREAKOUT_HEADLESS_H
+
+#include <breakout/game.h>
+#include <breakout/rollback.h>
+
+#define HEADLESS_DEFAULT_TICKS (DEFAULT_TICK_RATE * 60)
+
+// NOTE: Box2D holds the ball at the surface for the rest of the step it
+// bounces in, the backends drift apart by up to a step of travel per bounce.
+// The balls have to stay within a ball radius plus a step at max speed for
+// every bounce so far and the one under way, their velocities within the
+// share of the speed. The window covers about fifteen bounces
+#define PHYSICS_COMPARE_SECONDS            10
+#define PHYSICS_COMPARE_VELOCITY_TOLERANCE 0.05
+
+/*
+ * Cycles through moves, one character per ticks_per_move ticks:
+ * 'L' - move left, 'R' - move right, 'S' - reset ball, anything else - idle
+ */
+typedef struct InputScript {
+    const char *moves;
+    long        ticks_per_move;
+} InputScript;
+
+typedef struct HeadlessOptions {
+    long        games;
+    long        max_ticks;
+    InputSource input_source;
+    void       *input_user_data;
+} HeadlessOptions;
+
+typedef struct HeadlessReport {
+    long        games;
+    long        ticks;
+    long        balls_lost;
+    long        bricks_destroyed;
+    long        worker_count;
+    const char *physics;
+    double      seconds;
+    double      ticks_per_second;
+    // NOTE: as reported by the physics backend, in milliseconds
+    double      step_milliseconds;
+} HeadlessReport;
+
+/* Ball trajectories of two backends fed the same input */
+typedef struct PhysicsComparison {
+    const char *reference;
+    const char *candidate;
+    long        ticks;
+    // NOTE: PHYSICS_COMPARE_SECONDS at the tick rate
+    long        window_ticks;
+    // NOTE: wall, paddle and brick bounces of the reference ball
+    long        bounces;
+    // NOTE: first tick out of tolerance, -1 if none was
+    long        diverged_tick;
+    // NOTE: in pixels, up to the divergence
+    double      max_distance;
+    // NOTE: in pixels, distance allowed at the last compared tick
+    double      tolerance;
+    // NOTE: velocity difference as a share of the reference speed, up to the
+    // divergence and outside of bounces
+    double      max_velocity_error;
+} PhysicsComparison;
+
+HeadlessOptions DefaultHeadlessOptions(void);
+
+/* Keeps the paddle under the ball */
+GameInput AutopilotInput(const Configuration *config, long tick, void *user_data);
+
+/* user_data must point to an InputScript */
+GameInput ScriptedInput(const Configuration *config, long tick, void *user_data);
+
+/*
+ * Plays options->games games without a window, each one until the level is
+ * cleared or max_ticks ticks have been simulated. Time only advances through
+ * fixed ticks of 1 / config->tick_rate seconds, so the loop runs as fast as the
+ * CPU allows.
+ */
+HeadlessReport RunHeadless(
+    Configuration *config, const HeadlessOptions *options
+);
+
+void PrintHeadlessReport(const HeadlessReport *report);
+
+/*
+ * Plays one game on the Box2D backend and on candidate in lockstep, both
+ * driven by the input options->input_source produces for the Box2D game, for
+ * PHYSICS_COMPARE_SECONDS or until the balls are out of tolerance. Velocities
+ * are not compared on the ticks around a bounce of either ball, the backends
+ * may bounce a tick apart.
+ */
+PhysicsComparison ComparePhysics(
+    const Configuration   *config,
+    const HeadlessOptions *options,
+    const PhysicsBackend  *candidate
+);
+
+/* Returns true if the trajectories stayed within tolerance for the whole
+ * window */
+bool PrintPhysicsComparison(const PhysicsComparison *comparison);
+
+/*
+ * Plays a versus match against the peer at the other end of transport, the
+ * local paddle driven by options->input_source. Unlike RunHeadless it runs at
+ * the tick rate, the peer can only keep up in real time. Ends with the match,
+ * or when the peer stops answering.
+ */
+RollbackStats RunHeadlessVersus(
+    const Configuration   *config,
+    const HeadlessOptions *options,
+    const RollbackOptions *rollback_options,
+    NetTransport          *transport
+);
+
+#endif // BREAKOUT_HEADLESS_H
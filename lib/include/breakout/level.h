@@ -0,0 +1,66 @@
+#ifndef BREAKOUT_LEVEL_H
+#define BREAKOUT_LEVEL_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <breakout/file_map.h>
+
+#define LEVEL_MAGIC   "BKLV"
+#define LEVEL_VERSION 1
+
+#define LEVEL_HEADER_SIZE 16
+#define LEVEL_BRICK_SIZE  24
+
+#define LEVEL_MAX_HIT_POINTS 255
+
+/*
+ * Compiled level, all little endian:
+ *
+ *     header  magic "BKLV", u32 version, u32 brick count, u32 record size
+ *     bricks  f32 x, f32 y, f32 width, f32 height (pixels, top left corner),
+ *             u8 r, g, b, a, u8 hit points, 3 reserved bytes
+ *
+ * Records are fixed size so brick i is read straight from the mapped file,
+ * the record size in the header lets later versions append fields.
+ */
+typedef struct LevelBrick {
+    Vector2 position;
+    Vector2 size;
+    Color   color;
+    uint8_t hit_points;
+} LevelBrick;
+
+typedef struct LevelFile {
+    FileMap map;
+    int     brick_count;
+    int     record_size;
+} LevelFile;
+
+/* Maps a compiled level and checks its header and bricks, nothing is copied.
+ * Fails on a brick without hit points, a size that is not positive or a
+ * position that is not finite */
+bool OpenLevel(LevelFile *level, const char *path);
+void CloseLevel(LevelFile *level);
+
+LevelBrick GetLevelBrick(const LevelFile *level, int index);
+
+bool WriteLevel(const char *path, const LevelBrick *bricks, int count);
+
+/*
+ * Compiles a TOML level description:
+ *
+ *     [defaults]           # optional, used by bricks that omit a key
+ *     width = 60.0
+ *     height = 20.0
+ *     color = [255, 161, 0, 255]
+ *     hit_points = 1
+ *
+ *     [[bricks]]
+ *     x = 10.0
+ *     y = 10.0
+ *     hit_points = 2
+ */
+bool CompileLevel(const char *source_path, const char *level_path);
+
+#endif // BREAKOUT_LEVEL_H
@@ -0,0 +1,51 @@
+#ifndef BREAKOUT_NET_TRANSPORT_H
+#define BREAKOUT_NET_TRANSPORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NET_MAX_PACKET_SIZE 512
+
+// NOTE: packets held back for the injected latency, at one packet per tick
+// this is two seconds of them at 120 ticks per second
+#define NET_MAX_DELAYED_PACKETS 256
+
+#define NET_MAX_LATENCY_MILLISECONDS 1000
+
+/* Bad network injected on the sending side, a loopback round trip with both
+ * peers set to 50 ms of latency takes 100 ms */
+typedef struct NetConditions {
+    long   latency_milliseconds;
+    // NOTE: share of the packets sent that are dropped, from 0 to 1
+    double loss;
+} NetConditions;
+
+typedef struct NetStats {
+    long sent;
+    // NOTE: by the injected loss, or because the delay queue was full
+    long dropped;
+    long received;
+} NetStats;
+
+/*
+ * Non blocking UDP socket talking to a single peer. Datagrams from any other
+ * address are ignored. Delayed packets go out from SendNetPacket and
+ * ReceiveNetPacket, one of them has to be called regularly.
+ */
+typedef struct NetTransport NetTransport;
+
+/* Binds port on every interface, peer_host is a name or an IPv4 address.
+ * Returns NULL if the socket cannot be set up */
+NetTransport *OpenNetTransport(
+    int port, const char *peer_host, int peer_port, NetConditions conditions
+);
+void          CloseNetTransport(NetTransport *transport);
+
+/* Packets over NET_MAX_PACKET_SIZE bytes are not sent */
+void SendNetPacket(NetTransport *transport, const void *data, int size);
+/* Returns the size of the packet copied into buffer, 0 if none is waiting */
+int  ReceiveNetPacket(NetTransport *transport, void *buffer, int capacity);
+
+NetStats GetNetStats(const NetTransport *transport);
+
+#endif // BREAKOUT_NET_TRANSPORT_H
@@ -0,0 +1,86 @@
+#ifndef BREAKOUT_PHYSICS_H
+#define BREAKOUT_PHYSICS_H
+
+#include <box2d/box2d.h>
+#include <stdbool.h>
+
+// NOTE: more brick hits than this in one step are not reported, a ball
+// bounces off a handful at most
+#define PHYSICS_MAX_BRICK_HITS 64
+
+typedef struct Configuration Configuration;
+
+typedef enum PhysicsKind {
+    PHYSICS_BOX2D,
+    PHYSICS_ANALYTIC,
+    PHYSICS_KIND_COUNT,
+} PhysicsKind;
+
+/* What the ball began touching during the last step */
+typedef struct PhysicsHits {
+    int  bricks[PHYSICS_MAX_BRICK_HITS];
+    int  brick_count;
+    bool paddle;
+} PhysicsHits;
+
+/* Everything the analytic backend simulates, the bricks are read from the
+ * brick store and the walls are fixed */
+typedef struct AnalyticWorld {
+    b2Vec2 ball_position;
+    b2Vec2 ball_velocity;
+    b2Vec2 player_position;
+    b2Vec2 player_velocity;
+    double step_milliseconds;
+} AnalyticWorld;
+
+/*
+ * Simulation of the ball against the walls, the paddle and the live bricks of
+ * the brick store. The game only talks to the world through these, positions
+ * and velocities are in meters. The paddle is moved by its velocity and never
+ * pushed by the ball.
+ */
+typedef struct PhysicsBackend {
+    PhysicsKind kind;
+    const char *name;
+
+    /* Creates the paddle, the ball and the walls at their start */
+    void (*create_world)(Configuration *config);
+    /* Frees everything the backend holds, the bricks included */
+    void (*destroy_world)(Configuration *config);
+    /* Advances time_step seconds and fills config->hits */
+    void (*step)(Configuration *config, float time_step);
+    /* Time spent in the last step, in milliseconds */
+    double (*get_step_milliseconds)(const Configuration *config);
+
+    b2Vec2 (*get_ball_position)(const Configuration *config);
+    b2Vec2 (*get_ball_velocity)(const Configuration *config);
+    void   (*set_ball_position)(Configuration *config, b2Vec2 position);
+    void   (*set_ball_velocity)(Configuration *config, b2Vec2 velocity);
+    b2Vec2 (*get_player_position)(const Configuration *config);
+    b2Vec2 (*get_player_velocity)(const Configuration *config);
+    void   (*set_player_position)(Configuration *config, b2Vec2 position);
+    void   (*set_player_velocity)(Configuration *config, b2Vec2 velocity);
+    /* Applies a new paddle size and ball radius from the configuration */
+    void   (*resize)(Configuration *config);
+
+    /* Brick collision for a brick whose store slot was just filled or
+     * emptied, the live bit is already set or cleared */
+    void (*spawn_brick)(Configuration *config, int brick_index);
+    void (*destroy_brick)(Configuration *config, int brick_index);
+    /* Before the brick store goes away as a whole */
+    void (*destroy_all_bricks)(Configuration *config);
+} PhysicsBackend;
+
+/* Box2D world with continuous collision, the reference backend */
+extern const PhysicsBackend BOX2D_PHYSICS;
+
+/* Exact swept circle against boxes, no world, bodies or solver. Cannot
+ * scroll the bricks of endless mode */
+extern const PhysicsBackend ANALYTIC_PHYSICS;
+
+const PhysicsBackend *GetPhysicsBackend(PhysicsKind kind);
+
+/* NULL if no backend has that name */
+const PhysicsBackend *FindPhysicsBackend(const char *name);
+
+#endif // BREAKOUT_PHYSICS_H
@@ -0,0 +1,88 @@
+#ifndef BREAKOUT_PROFILER_H
+#define BREAKOUT_PROFILER_H
+
+#include <breakout/clock.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PROFILER_DEFAULT_CAPACITY 4096
+
+typedef enum ProfilePhase {
+    PROFILE_PHASE_INPUT,
+    PROFILE_PHASE_STEP,
+    // NOTE: split of the step as reported by b2World_GetProfile, Box2D runs
+    // its substeps internally so they cannot be timed one by one
+    PROFILE_PHASE_STEP_COLLIDE,
+    PROFILE_PHASE_STEP_SOLVE,
+    PROFILE_PHASE_COLLISIONS,
+    PROFILE_PHASE_CLAMP,
+    PROFILE_PHASE_BALLS,
+    PROFILE_PHASE_DRAW,
+    PROFILE_PHASE_PRESENT,
+    PROFILE_PHASE_FRAME,
+    PROFILE_PHASE_COUNT,
+} ProfilePhase;
+
+/*
+ * Per frame time of every phase in a ring of the last capacity frames, in
+ * nanoseconds. A phase that runs several times a frame (once per tick) is
+ * summed. Code paths take a Profiler pointer and do nothing when it is NULL,
+ * so a disabled profiler costs a branch per phase.
+ */
+typedef struct Profiler {
+    uint64_t  current[PROFILE_PHASE_COUNT];
+    uint64_t  frame_start;
+    uint64_t *samples;
+    uint64_t *scratch;
+    int       capacity;
+    int       head;
+    int       count;
+    long      frame;
+} Profiler;
+
+typedef struct ProfileStats {
+    double min_milliseconds;
+    double average_milliseconds;
+    double p99_milliseconds;
+} ProfileStats;
+
+void CreateProfiler(Profiler *profiler, int capacity);
+void FreeProfiler(Profiler *profiler);
+
+const char *GetProfilePhaseName(ProfilePhase phase);
+
+static inline uint64_t BeginProfileSample(const Profiler *profiler) {
+    return profiler ? GetClockNanoseconds() : 0;
+}
+
+/* Adds the time since start to phase, returns the current time so samples
+ * can be chained */
+static inline uint64_t EndProfileSample(
+    Profiler *profiler, ProfilePhase phase, uint64_t start
+) {
+    if (!profiler) {
+        return 0;
+    }
+
+    uint64_t now = GetClockNanoseconds();
+    profiler->current[phase] += now - start;
+    return now;
+}
+
+/* For durations measured elsewhere */
+void AddProfileTime(
+    Profiler *profiler, ProfilePhase phase, uint64_t nanoseconds
+);
+
+void BeginProfilerFrame(Profiler *profiler);
+/* Pushes the summed phases of the frame into the ring */
+void EndProfilerFrame(Profiler *profiler);
+
+/* Over the frames currently in the ring */
+ProfileStats GetProfileStats(Profiler *profiler, ProfilePhase phase);
+
+/* One line per frame in the ring, oldest first, times in milliseconds */
+bool WriteProfilerCsv(const Profiler *profiler, const char *path);
+
+#endif // BREAKOUT_PROFILER_H
@@ -0,0 +1,93 @@
+#ifndef BREAKOUT_RENDER_STATE_H
+#define BREAKOUT_RENDER_STATE_H
+
+#include <breakout/game.h>
+#include <stdatomic.h>
+
+#define RENDER_STATE_SLOTS 3
+
+/*
+ * Everything the renderer draws, copied out of the simulation after a tick
+ * so drawing never touches the world. Positions are in pixels, previous ones
+ * are from the tick before. Brick geometry only changes with the layout and is
+ * copied again only when layout_version moves.
+ */
+typedef struct RenderState {
+    long         tick;
+    // NOTE: GetClockNanoseconds at capture, the renderer interpolates from it
+    uint64_t     captured_at;
+    double       time_step;
+    Color        background_color;
+    Vector2      player_previous;
+    Vector2      player_position;
+    Vector2      player_size;
+    Color        player_color;
+    Vector2      ball_previous;
+    Vector2      ball_position;
+    b2Vec2       ball_velocity;
+    float        ball_radius;
+    Color        ball_color;
+    // NOTE: bricks destroyed so far
+    long         score;
+    // NOTE: versus mode, the other player's score as predicted, -1 outside
+    // of it, and the result once the match is over
+    long         opponent_score;
+    const char  *message;
+    // NOTE: endless mode, brick positions change every tick and are copied
+    // with every capture
+    bool         scrolling;
+    long         layout_version;
+    int          brick_count;
+    int          word_count;
+    int          brick_capacity;
+    uint64_t    *live;
+    Vector2     *brick_positions;
+    Vector2     *brick_sizes;
+    Color       *brick_colors;
+    int          swarm_count;
+    int          swarm_capacity;
+    float       *swarm_x;
+    float       *swarm_y;
+    float       *swarm_previous_x;
+    float       *swarm_previous_y;
+    bool         has_profile_stats;
+    ProfileStats profile_stats[PROFILE_PHASE_COUNT];
+} RenderState;
+
+/*
+ * Lock free triple buffer of render states. The simulation fills the write
+ * slot and swaps it with the ready one, the renderer swaps its read slot with
+ * the ready one when that is newer. Neither side waits, the renderer always
+ * gets the latest complete state and the simulation is never held up by a
+ * slow frame.
+ */
+typedef struct RenderStateBuffer {
+    RenderState slots[RENDER_STATE_SLOTS];
+    // NOTE: slot index, RENDER_STATE_FRESH is set when written since the
+    // last acquire
+    atomic_int  ready;
+    int         write;
+    int         read;
+} RenderStateBuffer;
+
+void CreateRenderStateBuffer(RenderStateBuffer *buffer);
+void FreeRenderStateBuffer(RenderStateBuffer *buffer);
+
+/* Simulation side, the slot to capture into next */
+RenderState *GetRenderStateWriteSlot(RenderStateBuffer *buffer);
+/* Copies the simulation into state, growing its arrays when needed. Brick
+ * geometry is copied only if state holds another layout_version */
+void CaptureRenderState(
+    RenderState         *state,
+    const Configuration *config,
+    long                 tick,
+    long                 layout_version
+);
+/* Simulation side, hands the write slot over to the renderer */
+void PublishRenderState(RenderStateBuffer *buffer);
+
+/* Render side, the newest published state. It stays valid and unchanged until
+ * the next call */
+const RenderState *AcquireRenderState(RenderStateBuffer *buffer);
+
+#endif // BREAKOUT_RENDER_STATE_H
@@ -0,0 +1,102 @@
+#ifndef BREAKOUT_REPLAY_H
+#define BREAKOUT_REPLAY_H
+
+#include <stdint.h>
+#include <raylib.h>
+#include <box2d/box2d.h>
+#include <breakout/physics.h>
+
+#define REPLAY_MAGIC   "BKRP"
+#define REPLAY_VERSION 3
+
+#define REPLAY_DEFAULT_HASH_INTERVAL 600
+
+#define REPLAY_INPUT_LEFT  (1 << 0)
+#define REPLAY_INPUT_RIGHT (1 << 1)
+#define REPLAY_INPUT_RESET (1 << 2)
+
+typedef struct Configuration Configuration;
+typedef struct GameInput     GameInput;
+
+/* Everything that shapes the simulation, restored before a replay */
+typedef struct ReplayHeader {
+    long        bricks_in_row;
+    long        tick_rate;
+    long        hash_interval;
+    double      player_width;
+    double      player_height;
+    double      player_movement_speed;
+    double      ball_radius;
+    double      ball_max_speed;
+    double      ball_min_speed_multiplier;
+    b2Vec2      ball_initial_velocity;
+    // NOTE: backends do not agree tick for tick, a recording only replays on
+    // its own
+    PhysicsKind physics;
+} ReplayHeader;
+
+/* input held for length consecutive ticks */
+typedef struct ReplayRun {
+    uint8_t  input;
+    uint32_t length;
+} ReplayRun;
+
+/*
+ * Per tick paddle input stored as runs, with a state hash every
+ * hash_interval ticks to catch divergence. On disk the header is followed by
+ * the runs as an input byte and a LEB128 length, then the hashes, all little
+ * endian, so a session of mostly held keys stays a few KB.
+ */
+typedef struct Replay {
+    ReplayHeader header;
+    long         tick_count;
+    ReplayRun   *runs;
+    int          run_count;
+    int          run_capacity;
+    uint32_t    *hashes;
+    int          hash_count;
+    int          hash_capacity;
+} Replay;
+
+typedef struct ReplayReport {
+    long   ticks;
+    long   checked_hashes;
+    // NOTE: first tick whose hash did not match, -1 if none did
+    long   diverged_tick;
+    double seconds;
+    double ticks_per_second;
+} ReplayReport;
+
+/* hash_interval of 0 records no hashes */
+void BeginRecording(
+    Replay *replay, const Configuration *config, long hash_interval
+);
+
+/* Called by TickGame after every tick while config->recorder is set */
+void RecordReplayTick(
+    Replay *replay, const Configuration *config, const GameInput *input
+);
+
+bool SaveReplay(const Replay *replay, const char *path);
+bool LoadReplay(Replay *replay, const char *path);
+void FreeReplay(Replay *replay);
+
+void ApplyReplayConfiguration(const Replay *replay, Configuration *config);
+
+/* FNV-1a over the ball and paddle state, the live brick bitset and the hit
+ * points of every brick */
+uint32_t HashGameState(const Configuration *config);
+/* Same hash of a state saved with SaveSnapshot, without restoring it */
+uint32_t HashSnapshot(const void *buffer);
+
+/* Paddle input as the byte of a run, versus mode sends the same bytes */
+uint8_t   EncodeReplayInput(const GameInput *input);
+GameInput DecodeReplayInput(uint8_t input);
+
+/* Plays the replay back as fast as possible on a fresh game built from
+ * config, checking every recorded hash */
+ReplayReport RunReplay(const Replay *replay, Configuration *config);
+
+void PrintReplayReport(const ReplayReport *report);
+
+#endif // BREAKOUT_REPLAY_H
@@ -0,0 +1,126 @@
+#ifndef BREAKOUT_ROLLBACK_H
+#define BREAKOUT_ROLLBACK_H
+
+#include <breakout/game.h>
+#include <breakout/net_transport.h>
+
+#define ROLLBACK_PLAYER_COUNT 2
+
+// NOTE: at 120 ticks per second the default predicts 100 ms ahead, a round
+// trip of about that is played without stalling
+#define ROLLBACK_MAX_DEPTH           32
+#define ROLLBACK_DEFAULT_DEPTH       12
+#define ROLLBACK_MAX_INPUT_DELAY     8
+#define ROLLBACK_DEFAULT_INPUT_DELAY 2
+
+// NOTE: player 1 binds this port and player 2 the next one
+#define ROLLBACK_DEFAULT_PORT 7777
+
+// NOTE: ticks between the state hashes the peers compare
+#define ROLLBACK_HASH_INTERVAL 60
+
+// NOTE: also how long a peer waits for the other one to start
+#define ROLLBACK_TIMEOUT_SECONDS 10.0
+
+typedef struct RollbackOptions {
+    // NOTE: 0 or 1, the two peers have to pick different ones
+    int  local_player;
+    // NOTE: ticks the remote input may be predicted for before the session
+    // stalls, the deepest rollback
+    int  max_depth;
+    // NOTE: ticks between sampling a local input and playing it, every tick
+    // of delay is one less to roll back
+    int  input_delay;
+    // NOTE: the match ends at this tick, 0 plays until a field is cleared
+    long max_ticks;
+} RollbackOptions;
+
+typedef enum RollbackOutcome {
+    ROLLBACK_PLAYING,
+    ROLLBACK_WON,
+    ROLLBACK_LOST,
+    ROLLBACK_DRAW,
+    ROLLBACK_DISCONNECTED,
+} RollbackOutcome;
+
+typedef struct RollbackStats {
+    RollbackOutcome outcome;
+    // NOTE: ticks confirmed by both peers
+    long            ticks;
+    long            rollbacks;
+    long            resimulated_ticks;
+    int             max_depth;
+    // NOTE: restoring and resimulating, in milliseconds
+    double          rollback_milliseconds;
+    double          max_rollback_milliseconds;
+    // NOTE: calls that could not run a tick without predicting too far
+    long            stalls;
+    // NOTE: calls held back for the peer to catch up
+    long            sync_waits;
+    long            checked_hashes;
+    // NOTE: first tick whose state hash differed between the peers, -1 if
+    // none did
+    long            desync_tick;
+    // NOTE: bricks destroyed, indexed by player
+    int             scores[ROLLBACK_PLAYER_COUNT];
+    int             local_player;
+    NetStats        net;
+} RollbackStats;
+
+/*
+ * Two player versus match with rollback netcode. Each player has a paddle,
+ * a ball and a brick field of their own, and every peer simulates both. The
+ * local input is sent to the remote peer with every tick, the remote one is
+ * predicted as its last known input until it arrives. When an input that
+ * arrives differs from its prediction, the remote field is restored from the
+ * snapshot of that tick and resimulated up to the present within the same
+ * call. Snapshots hold the ball and paddle state and the live bricks.
+ *
+ * Both fields always step on the analytic physics, Box2D does not resimulate
+ * the same ticks after a restore. The peers compare state hashes every
+ * ROLLBACK_HASH_INTERVAL ticks to catch a desync.
+ */
+typedef struct RollbackSession RollbackSession;
+
+RollbackOptions DefaultRollbackOptions(void);
+
+/* Both fields are built from config, its scheduler, recorder, profiler and
+ * telemetry are not inherited. transport may be NULL, remote inputs then
+ * only come from AddRemoteInput */
+RollbackSession *CreateRollbackSession(
+    const Configuration   *config,
+    const RollbackOptions *options,
+    NetTransport          *transport
+);
+void             DestroyRollbackSession(RollbackSession *session);
+
+/*
+ * Takes in the remote inputs that arrived, rolls back if one was mispredicted
+ * and runs one tick with local_input, unless the remote input would have to
+ * be predicted for more than max_depth ticks, this peer runs ahead and waits
+ * for the other one, or the match is over. Then sends the local inputs. Call
+ * once per tick period. Returns true if a tick ran.
+ */
+bool AdvanceRollback(RollbackSession *session, const GameInput *local_input);
+
+/* Remote input of a tick, as if it came in a packet. Inputs have to arrive
+ * in tick order, earlier ones are ignored */
+void AddRemoteInput(RollbackSession *session, long tick, GameInput input);
+
+/* True once the result is known to both peers, or the peer went silent */
+bool IsRollbackOver(const RollbackSession *session);
+
+/* Next tick to run */
+long           GetRollbackTick(const RollbackSession *session);
+Configuration *GetRollbackConfiguration(
+    RollbackSession *session, int player
+);
+/* Bricks destroyed by player so far, the remote field may be predicted */
+int            GetRollbackScore(const RollbackSession *session, int player);
+RollbackStats  GetRollbackStats(const RollbackSession *session);
+
+const char *GetRollbackOutcomeName(RollbackOutcome outcome);
+
+void PrintRollbackStats(const RollbackStats *stats);
+
+#endif // BREAKOUT_ROLLBACK_H
@@ -0,0 +1,86 @@
+#ifndef BREAKOUT_SNAPSHOT_H
+#define BREAKOUT_SNAPSHOT_H
+
+#include <breakout/game.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SNAPSHOT_DEFAULT_RING_CAPACITY 600
+
+/*
+ * Flat, pointer free image of the simulation: the Configuration scalars, the
+ * ball and paddle state and, right after the header, the live brick bitset
+ * followed by the hit points left on every brick. It can be copied with
+ * memcpy and saved to disk as is (in native byte order).
+ */
+typedef struct GameSnapshot {
+    uint32_t    size;
+    uint32_t    brick_count;
+    long        tick;
+    long        bricks_in_row;
+    long        tick_rate;
+    long        max_frame_ticks;
+    double      brick_width;
+    double      brick_height;
+    double      player_movement_speed;
+    double      player_width;
+    double      player_height;
+    double      ball_radius;
+    double      ball_max_speed;
+    double      ball_min_speed_multiplier;
+    b2Vec2      ball_initial_velocity;
+    // NOTE: the ball has no friction and never spins, position and velocity
+    // are all of its state
+    b2Vec2      ball_position;
+    b2Vec2      ball_velocity;
+    b2Vec2      ball_previous_position;
+    b2Vec2      player_position;
+    b2Vec2      player_velocity;
+    b2Vec2      player_previous_position;
+} GameSnapshot;
+
+/*
+ * Fixed number of preallocated snapshots, the oldest one is overwritten once
+ * the ring is full. Popping the newest snapshot steps back in time.
+ */
+typedef struct SnapshotRing {
+    uint8_t *buffer;
+    size_t   slot_size;
+    int      capacity;
+    int      head;
+    int      count;
+} SnapshotRing;
+
+/* Bytes needed for a snapshot of the current level */
+size_t GetSnapshotSize(const Configuration *config);
+
+/* Writes GetSnapshotSize(config) bytes into buffer, does not allocate */
+void SaveSnapshot(const Configuration *config, long tick, void *buffer);
+
+/*
+ * Puts the world back into the snapshotted state without rebuilding it, only
+ * bricks whose live bit differs are created or destroyed. Fails if the
+ * snapshot belongs to another brick layout or other paddle or ball sizes.
+ * Box2D contact caches are not part of the snapshot, the first step after a
+ * restore may warm start differently.
+ */
+bool RestoreSnapshot(Configuration *config, const void *buffer);
+
+/* Live bricks of the snapshot, without restoring it */
+int CountSnapshotBricks(const void *buffer);
+
+void CreateSnapshotRing(
+    SnapshotRing *ring, const Configuration *config, int capacity
+);
+void FreeSnapshotRing(SnapshotRing *ring);
+
+void PushSnapshot(SnapshotRing *ring, const Configuration *config, long tick);
+
+/* Slot of tick for rings indexed by tick instead of pushed to, it holds that
+ * tick's snapshot for as long as no tick capacity ticks later was saved */
+void *GetSnapshotSlot(const SnapshotRing *ring, long tick);
+
+/* Restores the newest snapshot and drops it, returns false when empty */
+bool PopSnapshot(SnapshotRing *ring, Configuration *config, long *tick);
+
+#endif // BREAKOUT_SNAPSHOT_H
@@ -0,0 +1,38 @@
+#ifndef BREAKOUT_SPSC_RING_H
+#define BREAKOUT_SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// NOTE: head and tail sit on their own cache lines so the two threads do not
+// invalidate each other's line on every push and pop. Padded rather than
+// aligned, rings also live in heap blocks that are not line aligned
+#define SPSC_RING_CACHE_LINE 64
+
+/*
+ * Lock free ring of fixed size items between exactly one producer and one
+ * consumer thread. Items are copied in and out, the capacity is rounded up to
+ * a power of two. Neither side ever blocks, a push into a full ring fails.
+ */
+typedef struct SpscRing {
+    uint8_t *items;
+    size_t   item_size;
+    uint32_t mask;
+    uint8_t  head_padding[SPSC_RING_CACHE_LINE];
+    atomic_uint_fast32_t head;
+    uint8_t  tail_padding[SPSC_RING_CACHE_LINE];
+    atomic_uint_fast32_t tail;
+    uint8_t  end_padding[SPSC_RING_CACHE_LINE];
+} SpscRing;
+
+void CreateSpscRing(SpscRing *ring, size_t item_size, uint32_t capacity);
+void FreeSpscRing(SpscRing *ring);
+
+/* Producer side, returns false if the ring is full */
+bool PushSpscRing(SpscRing *ring, const void *item);
+/* Consumer side, returns false if the ring is empty */
+bool PopSpscRing(SpscRing *ring, void *item);
+
+#endif // BREAKOUT_SPSC_RING_H
@@ -0,0 +1,59 @@
+#ifndef BREAKOUT_TASK_SCHEDULER_H
+#define BREAKOUT_TASK_SCHEDULER_H
+
+#include <stdint.h>
+
+#define TASK_SCHEDULER_MAX_WORKERS 64
+#define TASK_SCHEDULER_MAX_TASKS   128
+#define TASK_QUEUE_CAPACITY        256
+
+/* Same shape as b2TaskCallback, runs items [start_index, end_index) */
+typedef void TaskFunction(
+    int start_index, int end_index, uint32_t worker_index, void *context
+);
+
+/*
+ * Work stealing thread pool. Every worker owns a queue of ranges, a task is
+ * split into ranges spread over all queues and idle workers steal from the
+ * others. The thread that waits for a task helps running it, it is always
+ * worker 0, so worker indices stay below worker_count as Box2D expects.
+ */
+typedef struct TaskScheduler TaskScheduler;
+
+/* worker_count includes the calling thread, 1 runs everything inline */
+TaskScheduler *CreateTaskScheduler(int worker_count);
+void           DestroyTaskScheduler(TaskScheduler *scheduler);
+
+int GetTaskSchedulerWorkerCount(const TaskScheduler *scheduler);
+
+/* Returns a handle for FinishTask, or NULL if the task already ran inline */
+void *EnqueueTask(
+    TaskScheduler *scheduler,
+    TaskFunction  *function,
+    int            item_count,
+    int            min_range,
+    void          *context
+);
+void FinishTask(TaskScheduler *scheduler, void *task);
+
+/* EnqueueTask followed by FinishTask */
+void RunParallel(
+    TaskScheduler *scheduler,
+    TaskFunction  *function,
+    int            item_count,
+    int            min_range,
+    void          *context
+);
+
+/* b2WorldDef.enqueueTask and b2WorldDef.finishTask adapters, userTaskContext
+ * must be the scheduler */
+void *EnqueueBox2DTask(
+    TaskFunction *task,
+    int           item_count,
+    int           min_range,
+    void         *task_context,
+    void         *user_context
+);
+void FinishBox2DTask(void *user_task, void *user_context);
+
+#endif // BREAKOUT_TASK_SCHEDULER_H
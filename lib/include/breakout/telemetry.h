@@ -0,0 +1,76 @@
+#ifndef BREAKOUT_TELEMETRY_H
+#define BREAKOUT_TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define TELEMETRY_MAGIC   "BKTL"
+#define TELEMETRY_VERSION 1
+
+// NOTE: the writer drains the ring every few milliseconds, a full ring means
+// thousands of events within one of those
+#define TELEMETRY_RING_CAPACITY 8192
+
+typedef enum TelemetryEventType {
+    TELEMETRY_BRICK_DESTROYED,
+    TELEMETRY_PADDLE_HIT,
+    TELEMETRY_BALL_LOST,
+    TELEMETRY_SPEED_CLAMPED,
+    TELEMETRY_SPEED_BOOSTED,
+    // NOTE: written by the writer thread when the ring was full
+    TELEMETRY_EVENTS_DROPPED,
+    TELEMETRY_EVENT_TYPE_COUNT,
+} TelemetryEventType;
+
+/*
+ * One gameplay event. Which fields are set depends on the type:
+ * - brick destroyed: brick_index
+ * - paddle hit, ball lost: offset of the ball from the paddle center in
+ *   pixels and the ball speed in m/s
+ * - speed clamped, boosted: speed before and corrected_speed after in m/s
+ * - events dropped: dropped_count
+ */
+typedef struct TelemetryEvent {
+    uint32_t tick;
+    uint8_t  type;
+    union {
+        int32_t  brick_index;
+        uint32_t dropped_count;
+    };
+    float    offset;
+    float    speed;
+    float    corrected_speed;
+} TelemetryEvent;
+
+/*
+ * Gameplay event log. The game loop pushes fixed size records into a lock
+ * free ring and a writer thread drains it into a binary log, so recording an
+ * event never blocks, allocates or touches a file. Events that do not fit in
+ * a full ring are counted and the count is logged in their place. Functions
+ * taking a Telemetry do nothing when it is NULL.
+ *
+ * On disk the magic and version are followed by the tick rate, then one
+ * record per event: the type byte, the ticks since the previous event as
+ * LEB128 and the fields of the type, indices and counts as LEB128 and floats
+ * as 32 bits, all little endian.
+ */
+typedef struct Telemetry Telemetry;
+
+/* Creates the log and starts the writer thread, returns NULL if the file
+ * cannot be created */
+Telemetry *StartTelemetry(const char *path, long tick_rate);
+/* Writes out the events still queued, then stops the thread and closes the
+ * log */
+void       StopTelemetry(Telemetry *telemetry);
+
+/* Game loop side. Events are stamped with the ticks counted so far, rewound
+ * ticks are counted again */
+void RecordTelemetryEvent(Telemetry *telemetry, TelemetryEvent event);
+void AdvanceTelemetryTick(Telemetry *telemetry);
+
+/* Writes the events of a log as CSV, one row per event. Returns false if the
+ * log cannot be read or is damaged, the rows before the damage are written */
+bool DecodeTelemetryLog(const char *path, FILE *csv, long *event_count);
+
+#endif // BREAKOUT_TELEMETRY_H
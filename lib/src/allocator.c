@@ -0,0 +1,361 @@
+#include <breakout/allocator.h>
+#include <box2d/box2d.h>
+#include <tomlc17.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+#define MEMORY_POOL_MIN_SIZE   32
+#define MEMORY_POOL_SLAB_SIZE  (64 * 1024)
+#define MEMORY_HEADER_SIZE     16
+#define MEMORY_HEAP_BLOCK      -1
+
+/* Sits right before every block handed out */
+typedef struct MemoryHeader {
+    size_t   size;
+    uint16_t offset;
+    uint8_t  subsystem;
+    int8_t   pool_index;
+} MemoryHeader;
+
+_Static_assert(
+    sizeof(MemoryHeader) <= MEMORY_HEADER_SIZE, "header does not fit"
+);
+
+typedef struct MemoryCounters {
+    atomic_size_t bytes_in_use;
+    atomic_size_t peak_bytes;
+    atomic_long   allocation_count;
+} MemoryCounters;
+
+typedef struct PoolBlock {
+    struct PoolBlock *next;
+} PoolBlock;
+
+/* Free list of equally sized blocks carved out of slabs that are never
+ * returned, so a steady state reuses the same blocks */
+typedef struct Pool {
+    mtx_t      mutex;
+    size_t     block_size;
+    PoolBlock *free_blocks;
+} Pool;
+
+struct ArenaBlock {
+    ArenaBlock *next;
+    size_t      capacity;
+    size_t      used;
+    // NOTE: keeps the data that follows aligned for any type
+    max_align_t data[];
+};
+
+static MemoryCounters counters[MEMORY_SUBSYSTEM_COUNT];
+static Pool           pools[MEMORY_POOL_COUNT];
+static once_flag      pools_once = ONCE_FLAG_INIT;
+
+static const char *subsystem_names[MEMORY_SUBSYSTEM_COUNT] = {
+    [MEMORY_GAME] = "game",
+    [MEMORY_LEVEL] = "level",
+    [MEMORY_BOX2D] = "box2d",
+    [MEMORY_TOML] = "toml",
+};
+
+static void InitPools(void) {
+    for (int i = 0; i < MEMORY_POOL_COUNT; i++) {
+        mtx_init(&pools[i].mutex, mtx_plain);
+        pools[i].block_size = (size_t)MEMORY_POOL_MIN_SIZE << i;
+        pools[i].free_blocks = NULL;
+    }
+}
+
+static void CountAllocation(MemorySubsystem subsystem, size_t size) {
+    MemoryCounters *counter = &counters[subsystem];
+    size_t in_use = atomic_fetch_add(&counter->bytes_in_use, size) + size;
+    size_t peak = atomic_load(&counter->peak_bytes);
+
+    while (in_use > peak
+           && !atomic_compare_exchange_weak(&counter->peak_bytes, &peak, in_use)
+    ) {
+    }
+
+    atomic_fetch_add(&counter->allocation_count, 1);
+}
+
+static void CountFree(MemorySubsystem subsystem, size_t size) {
+    atomic_fetch_sub(&counters[subsystem].bytes_in_use, size);
+}
+
+static void *PoolAlloc(Pool *pool) {
+    mtx_lock(&pool->mutex);
+
+    if (!pool->free_blocks) {
+        // NOTE: a new slab is split into blocks that all go on the free list
+        char  *slab = malloc(MEMORY_POOL_SLAB_SIZE);
+        size_t count = MEMORY_POOL_SLAB_SIZE / pool->block_size;
+
+        if (!slab) {
+            mtx_unlock(&pool->mutex);
+            return NULL;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            PoolBlock *block = (PoolBlock *)(slab + i * pool->block_size);
+            block->next = pool->free_blocks;
+            pool->free_blocks = block;
+        }
+    }
+
+    PoolBlock *block = pool->free_blocks;
+    pool->free_blocks = block->next;
+
+    mtx_unlock(&pool->mutex);
+    return block;
+}
+
+static void PoolFree(Pool *pool, void *memory) {
+    PoolBlock *block = memory;
+
+    mtx_lock(&pool->mutex);
+    block->next = pool->free_blocks;
+    pool->free_blocks = block;
+    mtx_unlock(&pool->mutex);
+}
+
+static int GetPoolIndex(size_t size) {
+    for (int i = 0; i < MEMORY_POOL_COUNT; i++) {
+        if (size <= pools[i].block_size) {
+            return i;
+        }
+    }
+    return MEMORY_HEAP_BLOCK;
+}
+
+static MemoryHeader *GetHeader(void *memory) {
+    return (MemoryHeader *)((char *)memory - MEMORY_HEADER_SIZE);
+}
+
+static void *AllocAligned(
+    MemorySubsystem subsystem, size_t size, size_t alignment
+) {
+    call_once(&pools_once, InitPools);
+
+    if (alignment < MEMORY_HEADER_SIZE) {
+        alignment = MEMORY_HEADER_SIZE;
+    }
+
+    // NOTE: pool blocks are only aligned to the header size
+    int   pool_index = alignment == MEMORY_HEADER_SIZE
+                         ? GetPoolIndex(size + MEMORY_HEADER_SIZE)
+                         : MEMORY_HEAP_BLOCK;
+    char *raw;
+
+    if (pool_index != MEMORY_HEAP_BLOCK) {
+        raw = PoolAlloc(&pools[pool_index]);
+    } else {
+        raw = malloc(size + alignment + MEMORY_HEADER_SIZE);
+    }
+
+    if (!raw) {
+        return NULL;
+    }
+
+    uintptr_t start = (uintptr_t)raw + MEMORY_HEADER_SIZE;
+    char     *memory =
+        (char *)((start + alignment - 1) & ~(uintptr_t)(alignment - 1));
+
+    *GetHeader(memory) = (MemoryHeader){
+        .size = size,
+        .offset = (uint16_t)(memory - raw),
+        .subsystem = (uint8_t)subsystem,
+        .pool_index = (int8_t)pool_index,
+    };
+
+    CountAllocation(subsystem, size);
+    return memory;
+}
+
+void *MemoryAlloc(MemorySubsystem subsystem, size_t size) {
+    return AllocAligned(subsystem, size, MEMORY_HEADER_SIZE);
+}
+
+void *MemoryCalloc(MemorySubsystem subsystem, size_t count, size_t size) {
+    void *memory = MemoryAlloc(subsystem, count * size);
+
+    if (memory) {
+        memset(memory, 0, count * size);
+    }
+
+    return memory;
+}
+
+void *MemoryRealloc(MemorySubsystem subsystem, void *memory, size_t size) {
+    if (!memory) {
+        return MemoryAlloc(subsystem, size);
+    }
+
+    MemoryHeader *header = GetHeader(memory);
+
+    // NOTE: a pool block that still fits is kept as it is
+    if (header->pool_index != MEMORY_HEAP_BLOCK
+        && size + MEMORY_HEADER_SIZE <= pools[header->pool_index].block_size) {
+        CountFree(header->subsystem, header->size);
+        CountAllocation(header->subsystem, size);
+        header->size = size;
+        return memory;
+    }
+
+    void *resized = MemoryAlloc(header->subsystem, size);
+
+    if (resized) {
+        memcpy(resized, memory, header->size < size ? header->size : size);
+        MemoryFree(memory);
+    }
+
+    return resized;
+}
+
+void MemoryFree(void *memory) {
+    if (!memory) {
+        return;
+    }
+
+    MemoryHeader header = *GetHeader(memory);
+    char        *raw = (char *)memory - header.offset;
+
+    CountFree(header.subsystem, header.size);
+
+    if (header.pool_index != MEMORY_HEAP_BLOCK) {
+        PoolFree(&pools[header.pool_index], raw);
+    } else {
+        free(raw);
+    }
+}
+
+static void *Box2DAlloc(unsigned int size, int alignment) {
+    return AllocAligned(MEMORY_BOX2D, size, (size_t)alignment);
+}
+
+static void Box2DFree(void *memory) {
+    MemoryFree(memory);
+}
+
+static void *TomlRealloc(void *memory, size_t size) {
+    return MemoryRealloc(MEMORY_TOML, memory, size);
+}
+
+void InstallAllocators(void) {
+    b2SetAllocator(Box2DAlloc, Box2DFree);
+
+    toml_option_t option = toml_default_option();
+    option.mem_realloc = TomlRealloc;
+    option.mem_free = MemoryFree;
+    toml_set_option(option);
+}
+
+MemoryStats GetMemoryStats(MemorySubsystem subsystem) {
+    return (MemoryStats){
+        .bytes_in_use = atomic_load(&counters[subsystem].bytes_in_use),
+        .peak_bytes = atomic_load(&counters[subsystem].peak_bytes),
+        .allocation_count = atomic_load(&counters[subsystem].allocation_count),
+    };
+}
+
+const char *GetMemorySubsystemName(MemorySubsystem subsystem) {
+    return subsystem_names[subsystem];
+}
+
+long GetTotalAllocationCount(void) {
+    long count = 0;
+
+    for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+        count += atomic_load(&counters[i].allocation_count);
+    }
+
+    return count;
+}
+
+void InitArena(Arena *arena, size_t block_size) {
+    *arena = (Arena){ .block_size = block_size };
+}
+
+static ArenaBlock *CreateArenaBlock(size_t capacity) {
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + capacity);
+
+    if (block) {
+        *block = (ArenaBlock){ .capacity = capacity };
+    }
+
+    return block;
+}
+
+void *ArenaAlloc(Arena *arena, size_t size, size_t alignment) {
+    ArenaBlock *block = arena->current;
+
+    for (;;) {
+        if (block) {
+            // NOTE: aligned by address, block data only guarantees max_align_t
+            uintptr_t base = (uintptr_t)block->data;
+            uintptr_t end = base + block->used;
+            size_t    start =
+                ((end + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+
+            if (start + size <= block->capacity) {
+                void *memory = (char *)block->data + start;
+
+                block->used = start + size;
+                arena->current = block;
+                arena->used += size;
+                CountAllocation(MEMORY_LEVEL, size);
+
+                memset(memory, 0, size);
+                return memory;
+            }
+
+            if (block->next) {
+                block = block->next;
+                continue;
+            }
+        }
+
+        // NOTE: oversized requests get a block of their own
+        size_t      capacity = size + alignment > arena->block_size
+                                 ? size + alignment
+                                 : arena->block_size;
+        ArenaBlock *created = CreateArenaBlock(capacity);
+
+        if (!created) {
+            return NULL;
+        }
+
+        if (block) {
+            block->next = created;
+        } else {
+            arena->first = created;
+        }
+        block = created;
+    }
+}
+
+void ResetArena(Arena *arena) {
+    for (ArenaBlock *block = arena->first; block; block = block->next) {
+        block->used = 0;
+    }
+
+    CountFree(MEMORY_LEVEL, arena->used);
+    arena->current = arena->first;
+    arena->used = 0;
+}
+
+void FreeArena(Arena *arena) {
+    ResetArena(arena);
+
+    ArenaBlock *block = arena->first;
+
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    *arena = (Arena){ .block_size = arena->block_size };
+}
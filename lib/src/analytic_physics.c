@@ -0,0 +1,462 @@
+#include <breakout/physics.h>
+#include <breakout/clock.h>
+#include <breakout/game.h>
+#include <float.h>
+#include <math.h>
+
+// NOTE: a ball wedged in a corner bounces a few times per tick. After this
+// many the ball waits at its last impact for the rest of the tick instead of
+// tunneling, the paddle still moves for all of it
+#define ANALYTIC_MAX_BOUNCES 8
+
+typedef struct Box {
+    b2Vec2 min;
+    b2Vec2 max;
+} Box;
+
+typedef enum ImpactTarget {
+    IMPACT_NONE,
+    IMPACT_WALL,
+    IMPACT_PADDLE,
+    IMPACT_BRICK,
+} ImpactTarget;
+
+/* First thing the ball touches, time is a fraction of the swept motion */
+typedef struct Impact {
+    ImpactTarget target;
+    int          brick_index;
+    float        time;
+    b2Vec2       normal;
+} Impact;
+
+// NOTE: the same boxes as the Box2D walls
+static const Box WALLS[] = {
+    { { -2 * WALLS_WIDTH * METERS_PER_PIXEL, 0 },
+      { 0, HEIGHT * METERS_PER_PIXEL } },
+    { { WIDTH * METERS_PER_PIXEL, 0 },
+      { (WIDTH + 2 * WALLS_WIDTH) * METERS_PER_PIXEL,
+        HEIGHT * METERS_PER_PIXEL } },
+    { { 0, -2 * WALLS_WIDTH * METERS_PER_PIXEL },
+      { WIDTH * METERS_PER_PIXEL, 0 } },
+};
+
+#define WALL_COUNT (sizeof(WALLS) / sizeof(WALLS[0]))
+
+static float Dot(b2Vec2 a, b2Vec2 b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+/* Time at which a circle moving from start by motion touches the circle of
+ * the same radius around corner */
+static bool SweepCircleCorner(
+    b2Vec2  start,
+    b2Vec2  motion,
+    float   radius,
+    b2Vec2  corner,
+    float  *time,
+    b2Vec2 *normal
+) {
+    b2Vec2 offset = { start.x - corner.x, start.y - corner.y };
+    float  a = Dot(motion, motion);
+    float  b = Dot(offset, motion);
+    float  c = Dot(offset, offset) - radius * radius;
+
+    // NOTE: moving away, or already overlapping and on the way out
+    if (b >= 0.f) {
+        return false;
+    }
+
+    float discriminant = b * b - a * c;
+
+    if (discriminant < 0.f) {
+        return false;
+    }
+
+    float t = (-b - sqrtf(discriminant)) / a;
+
+    if (t < 0.f || t > 1.f) {
+        return false;
+    }
+
+    b2Vec2 contact = { offset.x + motion.x * t, offset.y + motion.y * t };
+    float  length = sqrtf(Dot(contact, contact));
+
+    *time = t;
+    *normal = (b2Vec2){ contact.x / length, contact.y / length };
+    return true;
+}
+
+/*
+ * Exact time of impact of a moving circle against a box, as a fraction of
+ * motion. The circle touches the box when its center enters the box grown by
+ * the radius with rounded corners: the slab test against the grown box finds
+ * the face, a hit in a corner region is settled against the corner circle.
+ * A circle that starts inside is not stopped, it only ever leaves.
+ */
+static bool SweepCircleBox(
+    b2Vec2  start,
+    b2Vec2  motion,
+    float   radius,
+    Box     box,
+    float  *time,
+    b2Vec2 *normal
+) {
+    float start_axes[2] = { start.x, start.y };
+    float motion_axes[2] = { motion.x, motion.y };
+    float min_axes[2] = { box.min.x - radius, box.min.y - radius };
+    float max_axes[2] = { box.max.x + radius, box.max.y + radius };
+    float enter = -FLT_MAX;
+    float leave = FLT_MAX;
+    int   enter_axis = -1;
+
+    for (int axis = 0; axis < 2; axis++) {
+        if (motion_axes[axis] == 0.f) {
+            if (start_axes[axis] < min_axes[axis]
+                || start_axes[axis] > max_axes[axis]) {
+                return false;
+            }
+            continue;
+        }
+
+        float slab_enter =
+            (min_axes[axis] - start_axes[axis]) / motion_axes[axis];
+        float slab_leave =
+            (max_axes[axis] - start_axes[axis]) / motion_axes[axis];
+
+        if (slab_enter > slab_leave) {
+            float swap = slab_enter;
+            slab_enter = slab_leave;
+            slab_leave = swap;
+        }
+
+        if (slab_enter > enter) {
+            enter = slab_enter;
+            enter_axis = axis;
+        }
+
+        if (slab_leave < leave) {
+            leave = slab_leave;
+        }
+    }
+
+    if (enter_axis < 0 || enter > leave || leave < 0.f || enter > 1.f) {
+        return false;
+    }
+
+    // NOTE: a start inside the grown box may still be in one of its corners,
+    // outside the rounded shape
+    bool inside = enter < 0.f;
+
+    if (inside) {
+        enter = 0.f;
+    }
+
+    b2Vec2 point = { start.x + motion.x * enter, start.y + motion.y * enter };
+    bool   outside_x = point.x < box.min.x || point.x > box.max.x;
+    bool   outside_y = point.y < box.min.y || point.y > box.max.y;
+
+    if (outside_x && outside_y) {
+        b2Vec2 corner = {
+            point.x < box.min.x ? box.min.x : box.max.x,
+            point.y < box.min.y ? box.min.y : box.max.y,
+        };
+
+        // NOTE: a path that misses the corner circle leaves the grown box
+        // without touching any other part of it
+        return SweepCircleCorner(start, motion, radius, corner, time, normal);
+    }
+
+    if (inside) {
+        return false;
+    }
+
+    *time = enter;
+    *normal = enter_axis == 0
+                ? (b2Vec2){ motion.x > 0.f ? -1.f : 1.f, 0.f }
+                : (b2Vec2){ 0.f, motion.y > 0.f ? -1.f : 1.f };
+    return true;
+}
+
+static void TestImpact(
+    Impact      *impact,
+    ImpactTarget target,
+    int          brick_index,
+    b2Vec2       start,
+    b2Vec2       motion,
+    float        radius,
+    Box          box
+) {
+    float  time;
+    b2Vec2 normal;
+
+    // NOTE: strictly earlier, ties go to the target tested first
+    if (SweepCircleBox(start, motion, radius, box, &time, &normal)
+        && time < impact->time) {
+        *impact = (Impact){ target, brick_index, time, normal };
+    }
+}
+
+static Box GetPlayerBox(const Configuration *config) {
+    b2Vec2 center = config->analytic.player_position;
+    float  half_width = PIXELS_TO_WORLD(config->player.width / 2);
+    float  half_height = PIXELS_TO_WORLD(config->player.height / 2);
+
+    return (Box){
+        { center.x - half_width, center.y - half_height },
+        { center.x + half_width, center.y + half_height },
+    };
+}
+
+static Box GetBrickBox(const BrickStore *bricks, int brick_index) {
+    Vector2 position = bricks->positions[brick_index];
+    Vector2 size = bricks->sizes[brick_index];
+
+    return (Box){
+        { PIXELS_TO_WORLD(position.x), PIXELS_TO_WORLD(position.y) },
+        { PIXELS_TO_WORLD(position.x + size.x),
+          PIXELS_TO_WORLD(position.y + size.y) },
+    };
+}
+
+/* Tests the live bricks in the grid cells under the swept ball */
+static void TestBrickImpacts(
+    const Configuration *config,
+    Impact              *impact,
+    b2Vec2               start,
+    b2Vec2               motion,
+    float                radius
+) {
+    const BrickStore *bricks = &config->bricks;
+    const BrickGrid  *grid = &config->brick_grid;
+
+    float     left = fminf(start.x, start.x + motion.x) - radius;
+    float     top = fminf(start.y, start.y + motion.y) - radius;
+    Rectangle area = {
+        WORLD_TO_PIXELS(left),
+        WORLD_TO_PIXELS(top),
+        WORLD_TO_PIXELS(fabsf(motion.x) + radius * 2),
+        WORLD_TO_PIXELS(fabsf(motion.y) + radius * 2),
+    };
+
+    int first_column, first_row, last_column, last_row;
+
+    if (!GetBrickGridCells(
+            grid, area, &first_column, &first_row, &last_column, &last_row
+        )) {
+        return;
+    }
+
+    for (int row = first_row; row <= last_row; row++) {
+        if (grid->row_live[row] == 0) {
+            continue;
+        }
+
+        for (int column = first_column; column <= last_column; column++) {
+            int cell = row * grid->columns + column;
+
+            for (int i = grid->cell_start[cell]; i < grid->cell_start[cell + 1];
+                 i++) {
+                int brick_index = grid->cell_bricks[i];
+
+                if (!IsBrickLive(bricks, brick_index)) {
+                    continue;
+                }
+
+                // NOTE: a brick over two cells is tested twice, the second
+                // test is never strictly earlier
+                TestImpact(
+                    impact,
+                    IMPACT_BRICK,
+                    brick_index,
+                    start,
+                    motion,
+                    radius,
+                    GetBrickBox(bricks, brick_index)
+                );
+            }
+        }
+    }
+}
+
+static Impact FindFirstImpact(const Configuration *config, float duration) {
+    const AnalyticWorld *world = &config->analytic;
+    Impact               impact = { .target = IMPACT_NONE, .time = FLT_MAX };
+    float                radius = PIXELS_TO_WORLD(config->ball.radius);
+    b2Vec2               start = world->ball_position;
+    b2Vec2               motion = { world->ball_velocity.x * duration,
+                                    world->ball_velocity.y * duration };
+
+    for (size_t i = 0; i < WALL_COUNT; i++) {
+        TestImpact(&impact, IMPACT_WALL, -1, start, motion, radius, WALLS[i]);
+    }
+
+    // NOTE: the paddle moves too, it is swept against in its own frame
+    b2Vec2 relative_motion = {
+        motion.x - world->player_velocity.x * duration,
+        motion.y - world->player_velocity.y * duration,
+    };
+
+    TestImpact(
+        &impact,
+        IMPACT_PADDLE,
+        -1,
+        start,
+        relative_motion,
+        radius,
+        GetPlayerBox(config)
+    );
+
+    TestBrickImpacts(config, &impact, start, motion, radius);
+    return impact;
+}
+
+static void AdvanceAnalyticWorld(AnalyticWorld *world, float duration) {
+    world->ball_position.x += world->ball_velocity.x * duration;
+    world->ball_position.y += world->ball_velocity.y * duration;
+    world->player_position.x += world->player_velocity.x * duration;
+    world->player_position.y += world->player_velocity.y * duration;
+}
+
+/* Reflects the ball's velocity relative to the surface, restitution above 1
+ * pushes it off faster than it came */
+static void BounceBall(
+    AnalyticWorld *world,
+    b2Vec2         normal,
+    b2Vec2         surface_velocity,
+    float          restitution
+) {
+    b2Vec2 relative = { world->ball_velocity.x - surface_velocity.x,
+                        world->ball_velocity.y - surface_velocity.y };
+    float  approach = Dot(relative, normal);
+
+    world->ball_velocity.x -= (1.f + restitution) * approach * normal.x;
+    world->ball_velocity.y -= (1.f + restitution) * approach * normal.y;
+}
+
+static void StepAnalyticWorld(Configuration *config, float time_step) {
+    uint64_t       start = GetClockNanoseconds();
+    AnalyticWorld *world = &config->analytic;
+    PhysicsHits   *hits = &config->hits;
+    float          remaining = time_step;
+
+    hits->brick_count = 0;
+    hits->paddle = false;
+
+    for (int bounce = 0; bounce < ANALYTIC_MAX_BOUNCES; bounce++) {
+        Impact impact = FindFirstImpact(config, remaining);
+
+        if (impact.target == IMPACT_NONE) {
+            AdvanceAnalyticWorld(world, remaining);
+            remaining = 0.f;
+            break;
+        }
+
+        float elapsed = remaining * impact.time;
+
+        AdvanceAnalyticWorld(world, elapsed);
+        remaining -= elapsed;
+
+        if (impact.target == IMPACT_PADDLE) {
+            BounceBall(
+                world, impact.normal, world->player_velocity, PLAYER_RESTITUTION
+            );
+            hits->paddle = true;
+            continue;
+        }
+
+        if (impact.target == IMPACT_BRICK
+            && hits->brick_count < PHYSICS_MAX_BRICK_HITS) {
+            hits->bricks[hits->brick_count++] = impact.brick_index;
+        }
+
+        BounceBall(world, impact.normal, b2Vec2_zero, 1.f);
+    }
+
+    // NOTE: the bounce cap was hit, the paddle input of the tick is not lost
+    if (remaining > 0.f) {
+        world->player_position.x += world->player_velocity.x * remaining;
+        world->player_position.y += world->player_velocity.y * remaining;
+    }
+
+    world->step_milliseconds = (GetClockNanoseconds() - start) / 1e6;
+}
+
+static void CreateAnalyticWorld(Configuration *config) {
+    config->world_id = b2_nullWorldId;
+    config->analytic = (AnalyticWorld){
+        .ball_position = GetBallStartPosition(),
+        .player_position = GetPlayerStartPosition(),
+    };
+}
+
+static void DestroyAnalyticWorld(Configuration *config) {
+    config->analytic = (AnalyticWorld){ 0 };
+}
+
+static double GetAnalyticStepMilliseconds(const Configuration *config) {
+    return config->analytic.step_milliseconds;
+}
+
+static b2Vec2 GetAnalyticBallPosition(const Configuration *config) {
+    return config->analytic.ball_position;
+}
+
+static b2Vec2 GetAnalyticBallVelocity(const Configuration *config) {
+    return config->analytic.ball_velocity;
+}
+
+static void SetAnalyticBallPosition(Configuration *config, b2Vec2 position) {
+    config->analytic.ball_position = position;
+}
+
+static void SetAnalyticBallVelocity(Configuration *config, b2Vec2 velocity) {
+    config->analytic.ball_velocity = velocity;
+}
+
+static b2Vec2 GetAnalyticPlayerPosition(const Configuration *config) {
+    return config->analytic.player_position;
+}
+
+static b2Vec2 GetAnalyticPlayerVelocity(const Configuration *config) {
+    return config->analytic.player_velocity;
+}
+
+static void SetAnalyticPlayerPosition(Configuration *config, b2Vec2 position) {
+    config->analytic.player_position = position;
+}
+
+static void SetAnalyticPlayerVelocity(Configuration *config, b2Vec2 velocity) {
+    config->analytic.player_velocity = velocity;
+}
+
+// NOTE: sizes and bricks are read from the configuration and the brick store
+// on every step, there is nothing to update
+static void IgnoreAnalyticChange(Configuration *config) {
+    (void)config;
+}
+
+static void IgnoreAnalyticBrick(Configuration *config, int brick_index) {
+    (void)config;
+    (void)brick_index;
+}
+
+const PhysicsBackend ANALYTIC_PHYSICS = {
+    .kind = PHYSICS_ANALYTIC,
+    .name = "analytic",
+    .create_world = CreateAnalyticWorld,
+    .destroy_world = DestroyAnalyticWorld,
+    .step = StepAnalyticWorld,
+    .get_step_milliseconds = GetAnalyticStepMilliseconds,
+    .get_ball_position = GetAnalyticBallPosition,
+    .get_ball_velocity = GetAnalyticBallVelocity,
+    .set_ball_position = SetAnalyticBallPosition,
+    .set_ball_velocity = SetAnalyticBallVelocity,
+    .get_player_position = GetAnalyticPlayerPosition,
+    .get_player_velocity = GetAnalyticPlayerVelocity,
+    .set_player_position = SetAnalyticPlayerPosition,
+    .set_player_velocity = SetAnalyticPlayerVelocity,
+    .resize = IgnoreAnalyticChange,
+    .spawn_brick = IgnoreAnalyticBrick,
+    .destroy_brick = IgnoreAnalyticBrick,
+    .destroy_all_bricks = IgnoreAnalyticChange,
+};
@@ -0,0 +1,366 @@
+#include <breakout/ball_swarm.h>
+#include <breakout/allocator.h>
+#include <math.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BALL_KERNEL_LANES 8
+#define BALL_KERNEL_NAME  "avx"
+#elif defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BALL_KERNEL_LANES 4
+#define BALL_KERNEL_NAME  "sse"
+#else
+#define BALL_KERNEL_LANES 1
+#define BALL_KERNEL_NAME  "scalar"
+#endif
+
+#if BALL_KERNEL_LANES > 1
+
+/*
+ * Thin layer over the intrinsics so every kernel is written once for AVX and
+ * SSE. Masks are lanes with all bits set where a comparison held.
+ */
+#if BALL_KERNEL_LANES == 8
+typedef __m256 Lanes;
+
+static inline Lanes LoadLanes(const float *p) { return _mm256_loadu_ps(p); }
+static inline void  StoreLanes(float *p, Lanes v) { _mm256_storeu_ps(p, v); }
+static inline Lanes SetLanes(float value) { return _mm256_set1_ps(value); }
+static inline Lanes AddLanes(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+static inline Lanes SubLanes(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+static inline Lanes MulLanes(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+static inline Lanes DivLanes(Lanes a, Lanes b) { return _mm256_div_ps(a, b); }
+static inline Lanes MinLanes(Lanes a, Lanes b) { return _mm256_min_ps(a, b); }
+static inline Lanes MaxLanes(Lanes a, Lanes b) { return _mm256_max_ps(a, b); }
+static inline Lanes SqrtLanes(Lanes a) { return _mm256_sqrt_ps(a); }
+static inline Lanes AndLanes(Lanes a, Lanes b) { return _mm256_and_ps(a, b); }
+static inline Lanes OrLanes(Lanes a, Lanes b) { return _mm256_or_ps(a, b); }
+static inline Lanes AndNotLanes(Lanes a, Lanes b) {
+    return _mm256_andnot_ps(a, b);
+}
+static inline Lanes LessLanes(Lanes a, Lanes b) {
+    return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+}
+static inline Lanes LessEqualLanes(Lanes a, Lanes b) {
+    return _mm256_cmp_ps(a, b, _CMP_LE_OQ);
+}
+static inline Lanes GreaterLanes(Lanes a, Lanes b) {
+    return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+}
+static inline int MaskBits(Lanes mask) { return _mm256_movemask_ps(mask); }
+#else
+typedef __m128 Lanes;
+
+static inline Lanes LoadLanes(const float *p) { return _mm_loadu_ps(p); }
+static inline void  StoreLanes(float *p, Lanes v) { _mm_storeu_ps(p, v); }
+static inline Lanes SetLanes(float value) { return _mm_set1_ps(value); }
+static inline Lanes AddLanes(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+static inline Lanes SubLanes(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+static inline Lanes MulLanes(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+static inline Lanes DivLanes(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+static inline Lanes MinLanes(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+static inline Lanes MaxLanes(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+static inline Lanes SqrtLanes(Lanes a) { return _mm_sqrt_ps(a); }
+static inline Lanes AndLanes(Lanes a, Lanes b) { return _mm_and_ps(a, b); }
+static inline Lanes OrLanes(Lanes a, Lanes b) { return _mm_or_ps(a, b); }
+static inline Lanes AndNotLanes(Lanes a, Lanes b) {
+    return _mm_andnot_ps(a, b);
+}
+static inline Lanes LessLanes(Lanes a, Lanes b) { return _mm_cmplt_ps(a, b); }
+static inline Lanes LessEqualLanes(Lanes a, Lanes b) {
+    return _mm_cmple_ps(a, b);
+}
+static inline Lanes GreaterLanes(Lanes a, Lanes b) {
+    return _mm_cmpgt_ps(a, b);
+}
+static inline int MaskBits(Lanes mask) { return _mm_movemask_ps(mask); }
+#endif
+
+/* a where mask is set, b elsewhere */
+static inline Lanes SelectLanes(Lanes mask, Lanes a, Lanes b) {
+    return OrLanes(AndLanes(mask, a), AndNotLanes(mask, b));
+}
+
+static inline Lanes AbsLanes(Lanes a) {
+    return AndNotLanes(SetLanes(-0.f), a);
+}
+
+static inline Lanes NegativeAbsLanes(Lanes a) {
+    return OrLanes(SetLanes(-0.f), a);
+}
+
+#endif // BALL_KERNEL_LANES > 1
+
+static float *CreateLanes(int capacity) {
+    return MemoryCalloc(MEMORY_GAME, capacity, sizeof(float));
+}
+
+void CreateBallSwarm(BallSwarm *swarm, int count) {
+    int capacity = (count + BALL_SWARM_PADDING - 1) / BALL_SWARM_PADDING
+                 * BALL_SWARM_PADDING;
+
+    *swarm = (BallSwarm){
+        .position_x = CreateLanes(capacity),
+        .position_y = CreateLanes(capacity),
+        .velocity_x = CreateLanes(capacity),
+        .velocity_y = CreateLanes(capacity),
+        .previous_x = CreateLanes(capacity),
+        .previous_y = CreateLanes(capacity),
+        .selected = MemoryCalloc(MEMORY_GAME, capacity, sizeof(int)),
+        .count = count,
+        .capacity = capacity,
+    };
+}
+
+void FreeBallSwarm(BallSwarm *swarm) {
+    MemoryFree(swarm->position_x);
+    MemoryFree(swarm->position_y);
+    MemoryFree(swarm->velocity_x);
+    MemoryFree(swarm->velocity_y);
+    MemoryFree(swarm->previous_x);
+    MemoryFree(swarm->previous_y);
+    MemoryFree(swarm->selected);
+    *swarm = (BallSwarm){ 0 };
+}
+
+const char *GetBallKernelName(void) {
+    return BALL_KERNEL_NAME;
+}
+
+void MoveBalls(BallSwarm *swarm, float time_step, float radius, float width) {
+#if BALL_KERNEL_LANES > 1
+    Lanes step = SetLanes(time_step);
+    Lanes min_x = SetLanes(radius);
+    Lanes max_x = SetLanes(width - radius);
+    Lanes min_y = SetLanes(radius);
+
+    for (int i = 0; i < swarm->count; i += BALL_KERNEL_LANES) {
+        Lanes velocity_x = LoadLanes(swarm->velocity_x + i);
+        Lanes velocity_y = LoadLanes(swarm->velocity_y + i);
+        Lanes x = AddLanes(
+            LoadLanes(swarm->position_x + i), MulLanes(velocity_x, step)
+        );
+        Lanes y = AddLanes(
+            LoadLanes(swarm->position_y + i), MulLanes(velocity_y, step)
+        );
+
+        velocity_x = SelectLanes(
+            LessLanes(x, min_x), AbsLanes(velocity_x), velocity_x
+        );
+        velocity_x = SelectLanes(
+            GreaterLanes(x, max_x), NegativeAbsLanes(velocity_x), velocity_x
+        );
+        velocity_y = SelectLanes(
+            LessLanes(y, min_y), AbsLanes(velocity_y), velocity_y
+        );
+
+        StoreLanes(swarm->position_x + i, MinLanes(MaxLanes(x, min_x), max_x));
+        StoreLanes(swarm->position_y + i, MaxLanes(y, min_y));
+        StoreLanes(swarm->velocity_x + i, velocity_x);
+        StoreLanes(swarm->velocity_y + i, velocity_y);
+    }
+#else
+    for (int i = 0; i < swarm->count; i++) {
+        float x = swarm->position_x[i] + swarm->velocity_x[i] * time_step;
+        float y = swarm->position_y[i] + swarm->velocity_y[i] * time_step;
+
+        if (x < radius) {
+            x = radius;
+            swarm->velocity_x[i] = fabsf(swarm->velocity_x[i]);
+        }
+        if (x > width - radius) {
+            x = width - radius;
+            swarm->velocity_x[i] = -fabsf(swarm->velocity_x[i]);
+        }
+        if (y < radius) {
+            y = radius;
+            swarm->velocity_y[i] = fabsf(swarm->velocity_y[i]);
+        }
+
+        swarm->position_x[i] = x;
+        swarm->position_y[i] = y;
+    }
+#endif
+}
+
+void ClampBallSpeeds(
+    BallSwarm *swarm, float max_speed, float min_speed_multiplier
+) {
+    float target_speed = max_speed * min_speed_multiplier;
+
+#if BALL_KERNEL_LANES > 1
+    Lanes max = SetLanes(max_speed);
+    Lanes slow = SetLanes(max_speed * 0.5f);
+    Lanes rest = SetLanes(BALL_SWARM_REST_SPEED);
+    Lanes target = SetLanes(target_speed);
+    Lanes one = SetLanes(1.f);
+
+    for (int i = 0; i < swarm->count; i += BALL_KERNEL_LANES) {
+        Lanes velocity_x = LoadLanes(swarm->velocity_x + i);
+        Lanes velocity_y = LoadLanes(swarm->velocity_y + i);
+        Lanes speed = SqrtLanes(AddLanes(
+            MulLanes(velocity_x, velocity_x), MulLanes(velocity_y, velocity_y)
+        ));
+        // NOTE: resting lanes divide by the rest speed instead of 0, their
+        // scale is thrown away below
+        Lanes divisor = MaxLanes(speed, rest);
+
+        Lanes too_fast = GreaterLanes(speed, max);
+        Lanes too_slow =
+            AndLanes(GreaterLanes(speed, rest), LessLanes(speed, slow));
+        Lanes scale = SelectLanes(
+            too_fast,
+            DivLanes(max, divisor),
+            SelectLanes(too_slow, DivLanes(target, divisor), one)
+        );
+
+        StoreLanes(swarm->velocity_x + i, MulLanes(velocity_x, scale));
+        StoreLanes(swarm->velocity_y + i, MulLanes(velocity_y, scale));
+    }
+#else
+    for (int i = 0; i < swarm->count; i++) {
+        float velocity_x = swarm->velocity_x[i];
+        float velocity_y = swarm->velocity_y[i];
+        float speed = sqrtf(velocity_x * velocity_x + velocity_y * velocity_y);
+        float scale = 1.f;
+
+        if (speed > max_speed) {
+            scale = max_speed / speed;
+        } else if (speed > BALL_SWARM_REST_SPEED && speed < max_speed * 0.5f) {
+            scale = target_speed / speed;
+        }
+
+        swarm->velocity_x[i] = velocity_x * scale;
+        swarm->velocity_y[i] = velocity_y * scale;
+    }
+#endif
+}
+
+void BounceBallsOffRectangle(
+    BallSwarm *swarm, float radius, Rectangle rectangle
+) {
+#if BALL_KERNEL_LANES > 1
+    Lanes left = SetLanes(rectangle.x - radius);
+    Lanes top = SetLanes(rectangle.y - radius);
+    Lanes right = SetLanes(rectangle.x + rectangle.width + radius);
+    Lanes bottom = SetLanes(rectangle.y + rectangle.height + radius);
+
+    for (int i = 0; i < swarm->count; i += BALL_KERNEL_LANES) {
+        Lanes x = LoadLanes(swarm->position_x + i);
+        Lanes y = LoadLanes(swarm->position_y + i);
+        Lanes velocity_y = LoadLanes(swarm->velocity_y + i);
+
+        // NOTE: the rectangle grown by the radius, corners are treated as
+        // square which a paddle never notices
+        Lanes inside = AndLanes(
+            AndLanes(LessEqualLanes(left, x), LessEqualLanes(x, right)),
+            AndLanes(LessEqualLanes(top, y), LessEqualLanes(y, bottom))
+        );
+
+        StoreLanes(
+            swarm->velocity_y + i,
+            SelectLanes(inside, NegativeAbsLanes(velocity_y), velocity_y)
+        );
+    }
+#else
+    float left = rectangle.x - radius;
+    float top = rectangle.y - radius;
+    float right = rectangle.x + rectangle.width + radius;
+    float bottom = rectangle.y + rectangle.height + radius;
+
+    for (int i = 0; i < swarm->count; i++) {
+        float x = swarm->position_x[i];
+        float y = swarm->position_y[i];
+
+        if (left <= x && x <= right && top <= y && y <= bottom) {
+            swarm->velocity_y[i] = -fabsf(swarm->velocity_y[i]);
+        }
+    }
+#endif
+}
+
+int SelectBallsBetween(BallSwarm *swarm, float min_y, float max_y) {
+    int selected_count = 0;
+
+#if BALL_KERNEL_LANES > 1
+    Lanes min = SetLanes(min_y);
+    Lanes max = SetLanes(max_y);
+
+    for (int i = 0; i < swarm->count; i += BALL_KERNEL_LANES) {
+        Lanes y = LoadLanes(swarm->position_y + i);
+        int   mask =
+            MaskBits(AndLanes(LessEqualLanes(min, y), LessLanes(y, max)));
+
+        // NOTE: most blocks select nothing, the padding past count is skipped
+        for (int lane = 0; mask != 0; lane++, mask >>= 1) {
+            if ((mask & 1) && i + lane < swarm->count) {
+                swarm->selected[selected_count++] = i + lane;
+            }
+        }
+    }
+#else
+    for (int i = 0; i < swarm->count; i++) {
+        float y = swarm->position_y[i];
+
+        if (min_y <= y && y < max_y) {
+            swarm->selected[selected_count++] = i;
+        }
+    }
+#endif
+
+    return selected_count;
+}
+
+uint32_t TestCircleRectangles(
+    float        x,
+    float        y,
+    float        radius,
+    const float *left,
+    const float *top,
+    const float *right,
+    const float *bottom,
+    int          count
+) {
+    uint32_t hits = 0;
+
+#if BALL_KERNEL_LANES > 1
+    Lanes center_x = SetLanes(x);
+    Lanes center_y = SetLanes(y);
+    Lanes radius_squared = SetLanes(radius * radius);
+
+    for (int i = 0; i < count; i += BALL_KERNEL_LANES) {
+        // NOTE: distance from the center to the closest point of each
+        // rectangle, 0 on the axes where the center is within its edges
+        Lanes closest_x = MinLanes(
+            MaxLanes(center_x, LoadLanes(left + i)), LoadLanes(right + i)
+        );
+        Lanes closest_y = MinLanes(
+            MaxLanes(center_y, LoadLanes(top + i)), LoadLanes(bottom + i)
+        );
+        Lanes dx = SubLanes(center_x, closest_x);
+        Lanes dy = SubLanes(center_y, closest_y);
+        Lanes distance_squared = AddLanes(MulLanes(dx, dx), MulLanes(dy, dy));
+
+        hits |= (uint32_t)MaskBits(LessLanes(distance_squared, radius_squared))
+             << i;
+    }
+
+    // NOTE: padding lanes hold stale rectangles
+    if (count < 32) {
+        hits &= ((uint32_t)1 << count) - 1;
+    }
+#else
+    for (int i = 0; i < count; i++) {
+        float dx = x - fminf(fmaxf(x, left[i]), right[i]);
+        float dy = y - fminf(fmaxf(y, top[i]), bottom[i]);
+
+        if (dx * dx + dy * dy < radius * radius) {
+            hits |= (uint32_t)1 << i;
+        }
+    }
+#endif
+
+    return hits;
+}
@@ -0,0 +1,304 @@
+#include <breakout/physics.h>
+#include <breakout/game.h>
+#include <stdint.h>
+#include <threads.h>
+
+// NOTE: brick shapes carry index + 1 in their user data, 0 is any other shape
+#define BRICK_USER_DATA(index) ((void *)(intptr_t)((index) + 1))
+#define USER_DATA_BRICK(data)  ((int)(intptr_t)(data) - 1)
+
+// NOTE: b2CreateWorld and b2DestroyWorld share a global world table without
+// locking, games may be created from several threads at once
+static mtx_t     world_mutex;
+static once_flag world_mutex_once = ONCE_FLAG_INIT;
+
+static void InitWorldMutex(void) {
+    mtx_init(&world_mutex, mtx_plain);
+}
+
+static void CreatePlayer(Configuration *config) {
+    b2BodyDef player_body_def = b2DefaultBodyDef();
+    player_body_def.type = b2_kinematicBody;
+    player_body_def.position = GetPlayerStartPosition();
+    config->player.body_id = b2CreateBody(config->world_id, &player_body_def);
+
+    b2Polygon player_collider = b2MakeBox(
+        PIXELS_TO_WORLD(config->player.width / 2),
+        PIXELS_TO_WORLD(config->player.height / 2)
+    );
+    b2ShapeDef player_shape_def = b2DefaultShapeDef();
+    player_shape_def.material.friction = 0.0f;
+    player_shape_def.material.restitution = PLAYER_RESTITUTION;
+    b2CreatePolygonShape(
+        config->player.body_id, &player_shape_def, &player_collider
+    );
+
+    config->player.collider = player_collider;
+}
+
+static void CreateBall(Configuration *config) {
+    b2BodyDef ball_body_def = b2DefaultBodyDef();
+    ball_body_def.type = b2_dynamicBody;
+    ball_body_def.position = GetBallStartPosition();
+    ball_body_def.linearDamping = 0.0f;
+    ball_body_def.angularDamping = 0.0f;
+
+    config->ball.body_id = b2CreateBody(config->world_id, &ball_body_def);
+
+    b2Circle ball_collider = { { 0, 0 }, PIXELS_TO_WORLD(config->ball.radius) };
+    b2ShapeDef ball_shape_def = b2DefaultShapeDef();
+    ball_shape_def.material.restitution = 1.0f;
+    ball_shape_def.material.friction = 0.0f;
+    ball_shape_def.enableContactEvents = true;
+    b2CreateCircleShape(config->ball.body_id, &ball_shape_def, &ball_collider);
+}
+
+static void CreateWalls(const Configuration *config) {
+    b2BodyDef wall_body_def = b2DefaultBodyDef();
+    wall_body_def.type = b2_staticBody;
+
+    b2ShapeDef wall_shape_def = b2DefaultShapeDef();
+    wall_shape_def.material.restitution = 1.0f;
+    wall_shape_def.material.friction = 0.0f;
+    wall_shape_def.enableContactEvents = false;
+
+    wall_body_def.position = (b2Vec2){ PIXELS_TO_WORLD(-WALLS_WIDTH),
+                                       PIXELS_TO_WORLD((double)HEIGHT / 2) };
+    b2BodyId  left_wall = b2CreateBody(config->world_id, &wall_body_def);
+    b2Polygon left_wall_collider = b2MakeBox(
+        PIXELS_TO_WORLD(WALLS_WIDTH), PIXELS_TO_WORLD((double)HEIGHT / 2)
+    );
+    b2CreatePolygonShape(left_wall, &wall_shape_def, &left_wall_collider);
+
+    wall_body_def.position = (b2Vec2){ PIXELS_TO_WORLD(WIDTH + WALLS_WIDTH),
+                                       PIXELS_TO_WORLD((double)HEIGHT / 2) };
+    b2BodyId  right_wall = b2CreateBody(config->world_id, &wall_body_def);
+    b2Polygon right_wall_collider = b2MakeBox(
+        PIXELS_TO_WORLD(WALLS_WIDTH), PIXELS_TO_WORLD((double)HEIGHT / 2)
+    );
+    b2CreatePolygonShape(right_wall, &wall_shape_def, &right_wall_collider);
+
+    wall_body_def.position = (b2Vec2){ PIXELS_TO_WORLD((double)WIDTH / 2),
+                                       PIXELS_TO_WORLD(-WALLS_WIDTH) };
+    b2BodyId  up_wall = b2CreateBody(config->world_id, &wall_body_def);
+    b2Polygon up_wall_collider = b2MakeBox(
+        PIXELS_TO_WORLD((double)WIDTH / 2), PIXELS_TO_WORLD(WALLS_WIDTH)
+    );
+    b2CreatePolygonShape(up_wall, &wall_shape_def, &up_wall_collider);
+}
+
+static void CreateBox2DWorld(Configuration *config) {
+    b2WorldDef world_def = b2DefaultWorldDef();
+    world_def.gravity = b2Vec2_zero;
+    world_def.enableContinuous = true;
+
+    if (config->scheduler) {
+        world_def.workerCount = GetTaskSchedulerWorkerCount(config->scheduler);
+        world_def.enqueueTask = EnqueueBox2DTask;
+        world_def.finishTask = FinishBox2DTask;
+        world_def.userTaskContext = config->scheduler;
+    }
+
+    call_once(&world_mutex_once, InitWorldMutex);
+    mtx_lock(&world_mutex);
+    config->world_id = b2CreateWorld(&world_def);
+    mtx_unlock(&world_mutex);
+
+    CreatePlayer(config);
+    CreateBall(config);
+    CreateWalls(config);
+}
+
+static void DestroyBox2DWorld(Configuration *config) {
+    // NOTE: the world takes every body with it, the chunk bodies included
+    call_once(&world_mutex_once, InitWorldMutex);
+    mtx_lock(&world_mutex);
+    b2DestroyWorld(config->world_id);
+    mtx_unlock(&world_mutex);
+    config->world_id = b2_nullWorldId;
+}
+
+static bool IsPlayerShape(const Configuration *config, b2ShapeId shape_id) {
+    return B2_ID_EQUALS(b2Shape_GetBody(shape_id), config->player.body_id);
+}
+
+static void StepBox2DWorld(Configuration *config, float time_step) {
+    PhysicsHits *hits = &config->hits;
+
+    b2World_Step(config->world_id, time_step, PHYSICS_SUBSTEP_COUNT);
+
+    if (config->profiler) {
+        b2Profile step_profile = b2World_GetProfile(config->world_id);
+        AddProfileTime(
+            config->profiler,
+            PROFILE_PHASE_STEP_COLLIDE,
+            (uint64_t)(step_profile.collide * 1e6)
+        );
+        AddProfileTime(
+            config->profiler,
+            PROFILE_PHASE_STEP_SOLVE,
+            (uint64_t)(step_profile.solve * 1e6)
+        );
+    }
+
+    b2ContactEvents events = b2World_GetContactEvents(config->world_id);
+
+    hits->brick_count = 0;
+    hits->paddle = false;
+
+    for (int i = 0; i < events.beginCount; i++) {
+        b2ContactBeginTouchEvent *event = &events.beginEvents[i];
+
+        int brick_index = USER_DATA_BRICK(b2Shape_GetUserData(event->shapeIdA));
+
+        if (brick_index < 0) {
+            brick_index = USER_DATA_BRICK(b2Shape_GetUserData(event->shapeIdB));
+        }
+
+        if (brick_index >= 0) {
+            if (hits->brick_count < PHYSICS_MAX_BRICK_HITS) {
+                hits->bricks[hits->brick_count++] = brick_index;
+            }
+        } else if (IsPlayerShape(config, event->shapeIdA)
+                   || IsPlayerShape(config, event->shapeIdB)) {
+            hits->paddle = true;
+        }
+    }
+}
+
+static double GetBox2DStepMilliseconds(const Configuration *config) {
+    return b2World_GetProfile(config->world_id).step;
+}
+
+static b2Vec2 GetBox2DBallPosition(const Configuration *config) {
+    return b2Body_GetPosition(config->ball.body_id);
+}
+
+static b2Vec2 GetBox2DBallVelocity(const Configuration *config) {
+    return b2Body_GetLinearVelocity(config->ball.body_id);
+}
+
+static void SetBox2DBallPosition(Configuration *config, b2Vec2 position) {
+    b2Body_SetTransform(config->ball.body_id, position, b2Rot_identity);
+}
+
+static void SetBox2DBallVelocity(Configuration *config, b2Vec2 velocity) {
+    b2Body_SetLinearVelocity(config->ball.body_id, velocity);
+}
+
+static b2Vec2 GetBox2DPlayerPosition(const Configuration *config) {
+    return b2Body_GetPosition(config->player.body_id);
+}
+
+static b2Vec2 GetBox2DPlayerVelocity(const Configuration *config) {
+    return b2Body_GetLinearVelocity(config->player.body_id);
+}
+
+static void SetBox2DPlayerPosition(Configuration *config, b2Vec2 position) {
+    b2Body_SetTransform(config->player.body_id, position, b2Rot_identity);
+}
+
+static void SetBox2DPlayerVelocity(Configuration *config, b2Vec2 velocity) {
+    b2Body_SetLinearVelocity(config->player.body_id, velocity);
+}
+
+static b2ShapeId GetBodyShape(b2BodyId body_id) {
+    b2ShapeId shape_id = b2_nullShapeId;
+    b2Body_GetShapes(body_id, &shape_id, 1);
+    return shape_id;
+}
+
+static void ResizeBox2DBodies(Configuration *config) {
+    config->player.collider = b2MakeBox(
+        PIXELS_TO_WORLD(config->player.width / 2),
+        PIXELS_TO_WORLD(config->player.height / 2)
+    );
+    b2Shape_SetPolygon(
+        GetBodyShape(config->player.body_id), &config->player.collider
+    );
+
+    b2Circle ball_collider = { { 0, 0 }, PIXELS_TO_WORLD(config->ball.radius) };
+    b2Shape_SetCircle(GetBodyShape(config->ball.body_id), &ball_collider);
+}
+
+static void SpawnBox2DBrick(Configuration *config, int brick_index) {
+    BrickStore *bricks = &config->bricks;
+    Vector2     position = bricks->positions[brick_index];
+    Vector2     size = bricks->sizes[brick_index];
+    b2BodyId   *body_id =
+        &bricks->chunk_body_ids[brick_index / bricks->chunk_size];
+
+    // NOTE: bricks are offset shapes on their chunk body, a static chunk body
+    // is created at the origin
+    if (B2_IS_NULL(*body_id)) {
+        b2BodyDef brick_body_def = b2DefaultBodyDef();
+        brick_body_def.type = b2_staticBody;
+        *body_id = b2CreateBody(config->world_id, &brick_body_def);
+    }
+
+    b2Vec2 origin = b2Body_GetPosition(*body_id);
+
+    b2ShapeDef brick_shape_def = b2DefaultShapeDef();
+    brick_shape_def.material.restitution = 1.0f;
+    brick_shape_def.material.friction = 0.0f;
+    brick_shape_def.enableContactEvents = true;
+    brick_shape_def.userData = BRICK_USER_DATA(brick_index);
+
+    b2Polygon brick_collider = b2MakeOffsetBox(
+        PIXELS_TO_WORLD(size.x / 2),
+        PIXELS_TO_WORLD(size.y / 2),
+        (b2Vec2){ PIXELS_TO_WORLD(position.x + size.x / 2) - origin.x,
+                  PIXELS_TO_WORLD(position.y + size.y / 2) - origin.y },
+        b2Rot_identity
+    );
+
+    bricks->shape_ids[brick_index] =
+        b2CreatePolygonShape(*body_id, &brick_shape_def, &brick_collider);
+}
+
+static void DestroyBox2DBrick(Configuration *config, int brick_index) {
+    BrickStore *bricks = &config->bricks;
+
+    // NOTE: static bodies have no mass to update
+    b2DestroyShape(bricks->shape_ids[brick_index], false);
+    bricks->shape_ids[brick_index] = b2_nullShapeId;
+}
+
+static void DestroyAllBox2DBricks(Configuration *config) {
+    BrickStore *bricks = &config->bricks;
+
+    // NOTE: destroying a chunk body takes all of its shapes with it
+    for (int chunk = 0; chunk < bricks->chunk_count; chunk++) {
+        if (B2_IS_NULL(bricks->chunk_body_ids[chunk])) {
+            continue;
+        }
+
+        b2DestroyBody(bricks->chunk_body_ids[chunk]);
+        bricks->chunk_body_ids[chunk] = b2_nullBodyId;
+    }
+
+    for (int i = 0; i < bricks->count; i++) {
+        bricks->shape_ids[i] = b2_nullShapeId;
+    }
+}
+
+const PhysicsBackend BOX2D_PHYSICS = {
+    .kind = PHYSICS_BOX2D,
+    .name = "box2d",
+    .create_world = CreateBox2DWorld,
+    .destroy_world = DestroyBox2DWorld,
+    .step = StepBox2DWorld,
+    .get_step_milliseconds = GetBox2DStepMilliseconds,
+    .get_ball_position = GetBox2DBallPosition,
+    .get_ball_velocity = GetBox2DBallVelocity,
+    .set_ball_position = SetBox2DBallPosition,
+    .set_ball_velocity = SetBox2DBallVelocity,
+    .get_player_position = GetBox2DPlayerPosition,
+    .get_player_velocity = GetBox2DPlayerVelocity,
+    .set_player_position = SetBox2DPlayerPosition,
+    .set_player_velocity = SetBox2DPlayerVelocity,
+    .resize = ResizeBox2DBodies,
+    .spawn_brick = SpawnBox2DBrick,
+    .destroy_brick = DestroyBox2DBrick,
+    .destroy_all_bricks = DestroyAllBox2DBricks,
+};
@@ -0,0 +1,211 @@
+#include <breakout/brick_grid.h>
+#include <math.h>
+
+// NOTE: cells are computed in double and clamped before the cast, a far
+// away brick or area would not fit a float difference or an int
+static double ToCell(double position, float origin, float cell_size) {
+    return (position - origin) / cell_size;
+}
+
+static int ClampCell(double cell, int count) {
+    if (cell < 0.0) {
+        return 0;
+    }
+    if (cell >= count) {
+        return count - 1;
+    }
+    return (int)cell;
+}
+
+static void GetBrickCells(
+    const BrickGrid *grid,
+    Vector2          position,
+    Vector2          brick_size,
+    int             *first_column,
+    int             *first_row,
+    int             *last_column,
+    int             *last_row
+) {
+    double left = ToCell(position.x, grid->origin.x, grid->cell_size.x);
+    double top = ToCell(position.y, grid->origin.y, grid->cell_size.y);
+    double right = ToCell(
+        (double)position.x + brick_size.x, grid->origin.x, grid->cell_size.x
+    );
+    double bottom = ToCell(
+        (double)position.y + brick_size.y, grid->origin.y, grid->cell_size.y
+    );
+
+    *first_column = ClampCell(floor(left), grid->columns);
+    *first_row = ClampCell(floor(top), grid->rows);
+    // NOTE: a brick ending exactly on a cell border does not touch the next one
+    *last_column = ClampCell(ceil(right) - 1.0, grid->columns);
+    *last_row = ClampCell(ceil(bottom) - 1.0, grid->rows);
+}
+
+void BuildBrickGrid(
+    BrickGrid     *grid,
+    const Vector2 *positions,
+    const Vector2 *sizes,
+    int            count,
+    Vector2        cell_size,
+    Arena         *arena
+) {
+    *grid = (BrickGrid){ .cell_size = cell_size };
+
+    if (count == 0) {
+        return;
+    }
+
+    Vector2 min = positions[0];
+    Vector2 max = { positions[0].x + sizes[0].x, positions[0].y + sizes[0].y };
+
+    for (int i = 1; i < count; i++) {
+        min.x = fminf(min.x, positions[i].x);
+        min.y = fminf(min.y, positions[i].y);
+        max.x = fmaxf(max.x, positions[i].x + sizes[i].x);
+        max.y = fmaxf(max.y, positions[i].y + sizes[i].y);
+    }
+
+    // NOTE: in double, the extent of far apart bricks may not fit a float
+    // and their cell count not an int
+    double width = (double)max.x - min.x;
+    double height = (double)max.y - min.y;
+    double scale = 1.0;
+
+    while (ceil(width / (cell_size.x * scale))
+               * ceil(height / (cell_size.y * scale))
+           > BRICK_GRID_MAX_CELLS) {
+        scale *= 2.0;
+    }
+
+    grid->origin = min;
+    grid->cell_size = (Vector2){ cell_size.x * scale, cell_size.y * scale };
+    grid->columns = (int)ceil(width / grid->cell_size.x);
+    grid->rows = (int)ceil(height / grid->cell_size.y);
+
+    int cell_count = grid->columns * grid->rows;
+
+    grid->cell_start = ARENA_ALLOC_ARRAY(arena, int, cell_count + 1);
+    grid->row_live = ARENA_ALLOC_ARRAY(arena, int, grid->rows);
+
+    int first_column, first_row, last_column, last_row;
+
+    // NOTE: counting sort, first pass counts bricks per cell, second fills
+    for (int i = 0; i < count; i++) {
+        GetBrickCells(
+            grid,
+            positions[i],
+            sizes[i],
+            &first_column,
+            &first_row,
+            &last_column,
+            &last_row
+        );
+
+        for (int row = first_row; row <= last_row; row++) {
+            grid->row_live[row]++;
+
+            for (int column = first_column; column <= last_column; column++) {
+                grid->cell_start[row * grid->columns + column + 1]++;
+            }
+        }
+    }
+
+    for (int cell = 0; cell < cell_count; cell++) {
+        grid->cell_start[cell + 1] += grid->cell_start[cell];
+    }
+
+    grid->cell_bricks =
+        ARENA_ALLOC_ARRAY(arena, int, grid->cell_start[cell_count]);
+
+    int *cursor = MemoryAlloc(MEMORY_GAME, sizeof(int) * cell_count);
+
+    for (int cell = 0; cell < cell_count; cell++) {
+        cursor[cell] = grid->cell_start[cell];
+    }
+
+    for (int i = 0; i < count; i++) {
+        GetBrickCells(
+            grid,
+            positions[i],
+            sizes[i],
+            &first_column,
+            &first_row,
+            &last_column,
+            &last_row
+        );
+
+        for (int row = first_row; row <= last_row; row++) {
+            for (int column = first_column; column <= last_column; column++) {
+                grid->cell_bricks[cursor[row * grid->columns + column]++] = i;
+            }
+        }
+    }
+
+    MemoryFree(cursor);
+}
+
+bool GetBrickGridCells(
+    const BrickGrid *grid,
+    Rectangle        area,
+    int             *first_column,
+    int             *first_row,
+    int             *last_column,
+    int             *last_row
+) {
+    if (grid->columns == 0 || grid->rows == 0) {
+        return false;
+    }
+
+    double left = floor(ToCell(area.x, grid->origin.x, grid->cell_size.x));
+    double top = floor(ToCell(area.y, grid->origin.y, grid->cell_size.y));
+    double right = floor(ToCell(
+        (double)area.x + area.width, grid->origin.x, grid->cell_size.x
+    ));
+    double bottom = floor(ToCell(
+        (double)area.y + area.height, grid->origin.y, grid->cell_size.y
+    ));
+
+    if (right < 0.0 || bottom < 0.0 || left >= grid->columns
+        || top >= grid->rows) {
+        return false;
+    }
+
+    *first_column = ClampCell(left, grid->columns);
+    *first_row = ClampCell(top, grid->rows);
+    *last_column = ClampCell(right, grid->columns);
+    *last_row = ClampCell(bottom, grid->rows);
+    return true;
+}
+
+static void AddToRowLive(
+    BrickGrid *grid, Vector2 position, Vector2 brick_size, int delta
+) {
+    int first_column, first_row, last_column, last_row;
+
+    GetBrickCells(
+        grid,
+        position,
+        brick_size,
+        &first_column,
+        &first_row,
+        &last_column,
+        &last_row
+    );
+
+    for (int row = first_row; row <= last_row; row++) {
+        grid->row_live[row] += delta;
+    }
+}
+
+void RemoveBrickFromGrid(
+    BrickGrid *grid, Vector2 position, Vector2 brick_size
+) {
+    AddToRowLive(grid, position, brick_size, -1);
+}
+
+void RestoreBrickInGrid(
+    BrickGrid *grid, Vector2 position, Vector2 brick_size
+) {
+    AddToRowLive(grid, position, brick_size, 1);
+}
@@ -0,0 +1,91 @@
+#include <breakout/brick_store.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static int CountTrailingZeros(uint64_t bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return (int)index;
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+static int PopCount(uint64_t bits) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(bits);
+#else
+    return __builtin_popcountll(bits);
+#endif
+}
+
+void CreateBrickStore(
+    BrickStore *store, int count, int chunk_size, Arena *arena
+) {
+    store->count = count;
+    store->word_count =
+        (count + BRICK_STORE_WORD_BITS - 1) / BRICK_STORE_WORD_BITS;
+    store->positions = ARENA_ALLOC_ARRAY(arena, Vector2, count);
+    store->sizes = ARENA_ALLOC_ARRAY(arena, Vector2, count);
+    store->colors = ARENA_ALLOC_ARRAY(arena, Color, count);
+    store->hit_points = ARENA_ALLOC_ARRAY(arena, uint8_t, count);
+    store->shape_ids = ARENA_ALLOC_ARRAY(arena, b2ShapeId, count);
+    store->chunk_size = chunk_size;
+    store->chunk_count = (count + chunk_size - 1) / chunk_size;
+    store->chunk_body_ids =
+        ARENA_ALLOC_ARRAY(arena, b2BodyId, store->chunk_count);
+    store->live = ARENA_ALLOC_ARRAY(arena, uint64_t, store->word_count);
+    store->destroy_queue = ARENA_ALLOC_ARRAY(arena, int, count);
+    store->destroy_count = 0;
+}
+
+void SetBrickLive(BrickStore *store, int index, bool live) {
+    uint64_t mask = (uint64_t)1 << (index % BRICK_STORE_WORD_BITS);
+
+    if (live) {
+        store->live[index / BRICK_STORE_WORD_BITS] |= mask;
+    } else {
+        store->live[index / BRICK_STORE_WORD_BITS] &= ~mask;
+    }
+}
+
+int NextLiveBrick(const BrickStore *store, int from) {
+    if (from >= store->count) {
+        return -1;
+    }
+
+    int      word = from / BRICK_STORE_WORD_BITS;
+    uint64_t bits =
+        store->live[word] & (~(uint64_t)0 << (from % BRICK_STORE_WORD_BITS));
+
+    while (bits == 0) {
+        if (++word >= store->word_count) {
+            return -1;
+        }
+        bits = store->live[word];
+    }
+
+    return word * BRICK_STORE_WORD_BITS + CountTrailingZeros(bits);
+}
+
+int CountLiveBricks(const BrickStore *store) {
+    int count = 0;
+
+    for (int word = 0; word < store->word_count; word++) {
+        count += PopCount(store->live[word]);
+    }
+
+    return count;
+}
+
+void QueueBrickDestruction(BrickStore *store, int index) {
+    if (!IsBrickLive(store, index)) {
+        return;
+    }
+
+    SetBrickLive(store, index, false);
+    store->destroy_queue[store->destroy_count++] = index;
+}
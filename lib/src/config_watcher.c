@@ -0,0 +1,220 @@
+#include <breakout/config_watcher.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+// NOTE: how often the thread looks at the stop flag, and the polling interval
+// where inotify is not available
+#define WATCHER_INTERVAL_MILLISECONDS 200
+
+struct ConfigWatcher {
+    char                    *path;
+    thrd_t                   thread;
+    atomic_bool              stop;
+    _Atomic(Configuration *) pending;
+#ifdef __linux__
+    int                      inotify_fd;
+    // NOTE: the directory is watched, editors often replace the file with a
+    // rename, which a watch on the file itself would not survive
+    const char              *file_name;
+#else
+    time_t                   modified;
+#endif
+};
+
+static void ReloadConfiguration(ConfigWatcher *watcher) {
+    Configuration *reloaded = MemoryAlloc(MEMORY_GAME, sizeof(Configuration));
+    Configuration  defaults = DefaultConfiguration();
+
+    // NOTE: memcpy, the configuration has const members and cannot be assigned
+    memcpy(reloaded, &defaults, sizeof(Configuration));
+
+    if (!ProcessConfiguration(watcher->path, reloaded)) {
+        MemoryFree(reloaded);
+        return;
+    }
+
+    MemoryFree(atomic_exchange(&watcher->pending, reloaded));
+}
+
+#ifdef __linux__
+static bool OpenWatch(ConfigWatcher *watcher) {
+    const char *slash = strrchr(watcher->path, '/');
+    char        directory[PATH_MAX] = ".";
+
+    if (slash) {
+        // NOTE: a file in the root keeps its slash as the directory
+        size_t length =
+            slash == watcher->path ? 1 : (size_t)(slash - watcher->path);
+
+        if (length >= sizeof(directory)) {
+            return false;
+        }
+
+        memcpy(directory, watcher->path, length);
+        directory[length] = '\0';
+        watcher->file_name = slash + 1;
+    } else {
+        watcher->file_name = watcher->path;
+    }
+
+    watcher->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (watcher->inotify_fd < 0) {
+        return false;
+    }
+
+    if (inotify_add_watch(
+            watcher->inotify_fd,
+            directory,
+            IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE
+        )
+        < 0) {
+        close(watcher->inotify_fd);
+        return false;
+    }
+
+    return true;
+}
+
+static void CloseWatch(ConfigWatcher *watcher) {
+    close(watcher->inotify_fd);
+}
+
+/* Drains the pending events, true if one of them was about the file */
+static bool WaitForChange(ConfigWatcher *watcher) {
+    struct pollfd descriptor = { watcher->inotify_fd, POLLIN, 0 };
+
+    if (poll(&descriptor, 1, WATCHER_INTERVAL_MILLISECONDS) <= 0) {
+        return false;
+    }
+
+    _Alignas(struct inotify_event) char buffer[4096];
+    bool changed = false;
+
+    for (;;) {
+        ssize_t length = read(watcher->inotify_fd, buffer, sizeof(buffer));
+
+        if (length <= 0) {
+            break;
+        }
+
+        for (char *cursor = buffer; cursor < buffer + length;) {
+            const struct inotify_event *event = (void *)cursor;
+
+            if (event->len > 0
+                && strcmp(event->name, watcher->file_name) == 0) {
+                changed = true;
+            }
+
+            cursor += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    return changed;
+}
+#else
+static time_t GetModifiedTime(const char *path) {
+    struct stat status;
+    return stat(path, &status) == 0 ? status.st_mtime : 0;
+}
+
+static bool OpenWatch(ConfigWatcher *watcher) {
+    watcher->modified = GetModifiedTime(watcher->path);
+    return watcher->modified != 0;
+}
+
+static void CloseWatch(ConfigWatcher *watcher) {
+    (void)watcher;
+}
+
+static bool WaitForChange(ConfigWatcher *watcher) {
+    struct timespec interval = {
+        .tv_nsec = WATCHER_INTERVAL_MILLISECONDS * 1000000L,
+    };
+    thrd_sleep(&interval, NULL);
+
+    time_t modified = GetModifiedTime(watcher->path);
+
+    if (modified == 0 || modified == watcher->modified) {
+        return false;
+    }
+
+    watcher->modified = modified;
+    return true;
+}
+#endif
+
+static int WatcherMain(void *argument) {
+    ConfigWatcher *watcher = argument;
+
+    while (!atomic_load(&watcher->stop)) {
+        if (WaitForChange(watcher)) {
+            ReloadConfiguration(watcher);
+        }
+    }
+
+    return 0;
+}
+
+ConfigWatcher *StartConfigWatcher(const char *path) {
+    ConfigWatcher *watcher =
+        MemoryCalloc(MEMORY_GAME, 1, sizeof(ConfigWatcher));
+    size_t         length = strlen(path);
+
+    watcher->path = MemoryAlloc(MEMORY_GAME, length + 1);
+    memcpy(watcher->path, path, length + 1);
+    atomic_init(&watcher->stop, false);
+    atomic_init(&watcher->pending, NULL);
+
+    if (!OpenWatch(watcher)) {
+        fprintf(stderr, "Failed to watch configuration file \"%s\"\n", path);
+        MemoryFree(watcher->path);
+        MemoryFree(watcher);
+        return NULL;
+    }
+
+    if (thrd_create(&watcher->thread, WatcherMain, watcher) != thrd_success) {
+        CloseWatch(watcher);
+        MemoryFree(watcher->path);
+        MemoryFree(watcher);
+        return NULL;
+    }
+
+    return watcher;
+}
+
+void StopConfigWatcher(ConfigWatcher *watcher) {
+    atomic_store(&watcher->stop, true);
+    thrd_join(watcher->thread, NULL);
+
+    CloseWatch(watcher);
+    MemoryFree(atomic_load(&watcher->pending));
+    MemoryFree(watcher->path);
+    MemoryFree(watcher);
+}
+
+Configuration *TakeReloadedConfiguration(ConfigWatcher *watcher) {
+    // NOTE: cheap enough to call every frame, a load avoids the exchange
+    if (!atomic_load_explicit(&watcher->pending, memory_order_relaxed)) {
+        return NULL;
+    }
+
+    return atomic_exchange(&watcher->pending, NULL);
+}
+
+void FreeReloadedConfiguration(Configuration *config) {
+    MemoryFree(config);
+}
@@ -0,0 +1,172 @@
+#include <breakout/game.h>
+#include <tomlc17.h>
+#include <stdio.h>
+
+#define TOML_GET_INT64(tab, key, var)                                                      \
+    {                                                                                      \
+        toml_datum_t value = toml_seek(tab, key);                                          \
+        if (value.type != TOML_INT64) {                                                    \
+            fprintf(                                                                       \
+                stderr,                                                                    \
+                "Failed to parse int64 from configuration with key \"%s\", skipping...\n", \
+                key                                                                        \
+            );                                                                             \
+        } else {                                                                           \
+            var = value.u.int64;                                                           \
+        }                                                                                  \
+    }
+
+#define TOML_GET_F64(tab, key, var)                                                          \
+    {                                                                                        \
+        toml_datum_t value = toml_seek(tab, key);                                            \
+        if (value.type != TOML_FP64) {                                                       \
+            fprintf(                                                                         \
+                stderr,                                                                      \
+                "Failed to parse float64 from configuration with key \"%s\", skipping...\n", \
+                key                                                                          \
+            );                                                                               \
+        } else {                                                                             \
+            var = value.u.fp64;                                                              \
+        }                                                                                    \
+    }
+
+bool ProcessConfiguration(const char *path, Configuration *configuration) {
+    FILE *config_file = fopen(path, "r");
+
+    if (!config_file) {
+        fprintf(stderr, "Failed to open configuration file, skipping...\n");
+        return false;
+    }
+
+    toml_result_t parse_result = toml_parse_file(config_file);
+
+    if (!parse_result.ok) {
+        fprintf(
+            stderr,
+            "Failed to read configuration file with error:\n%s, skipping...\n",
+            parse_result.errmsg
+        );
+
+        fclose(config_file);
+        toml_free(parse_result);
+        return false;
+    }
+
+    TOML_GET_INT64(
+        parse_result.toptab, "game.bricks_in_row", configuration->bricks_in_row
+    );
+    TOML_GET_INT64(
+        parse_result.toptab, "game.tick_rate", configuration->tick_rate
+    );
+    TOML_GET_INT64(
+        parse_result.toptab,
+        "game.max_frame_ticks",
+        configuration->max_frame_ticks
+    );
+    TOML_GET_INT64(
+        parse_result.toptab, "game.worker_count", configuration->worker_count
+    );
+    TOML_GET_INT64(
+        parse_result.toptab, "player.width", configuration->player.width
+    );
+    TOML_GET_INT64(
+        parse_result.toptab, "player.height", configuration->player.height
+    );
+    TOML_GET_F64(
+        parse_result.toptab,
+        "player.movement_speed",
+        configuration->player.movement_speed
+    );
+    TOML_GET_F64(
+        parse_result.toptab, "ball.radius", configuration->ball.radius
+    );
+    TOML_GET_F64(
+        parse_result.toptab,
+        "ball.min_speed_multiplier",
+        configuration->ball.min_speed_multiplier
+    );
+
+    // NOTE: optional, most configurations play with a single ball
+    if (toml_seek(parse_result.toptab, "ball.count").type != TOML_UNKNOWN) {
+        TOML_GET_INT64(
+            parse_result.toptab, "ball.count", configuration->ball_count
+        );
+    }
+
+    // NOTE: optional, endless mode is off unless it is set
+    if (toml_seek(parse_result.toptab, "game.scroll_speed").type
+        != TOML_UNKNOWN) {
+        TOML_GET_F64(
+            parse_result.toptab,
+            "game.scroll_speed",
+            configuration->scroll_speed
+        );
+    }
+
+    // NOTE: optional, Box2D unless it is set
+    toml_datum_t physics = toml_seek(parse_result.toptab, "game.physics");
+
+    if (physics.type == TOML_STRING) {
+        const PhysicsBackend *backend = FindPhysicsBackend(physics.u.s);
+
+        if (backend) {
+            configuration->physics = backend;
+        } else {
+            fprintf(
+                stderr,
+                "Unknown physics \"%s\" in configuration, skipping...\n",
+                physics.u.s
+            );
+        }
+    } else if (physics.type != TOML_UNKNOWN) {
+        fprintf(
+            stderr,
+            "Failed to parse string from configuration with key "
+            "\"game.physics\", skipping...\n"
+        );
+    }
+
+    // NOTE: brick widths are divided by it and the store is sized from it
+    if (configuration->bricks_in_row <= 0) {
+        fprintf(
+            stderr, "Bricks in a row must be positive, using the default\n"
+        );
+        configuration->bricks_in_row = BRICKS_IN_ROW;
+    }
+
+    if (configuration->tick_rate <= 0) {
+        fprintf(stderr, "Tick rate must be positive, using the default\n");
+        configuration->tick_rate = DEFAULT_TICK_RATE;
+    }
+
+    if (configuration->max_frame_ticks <= 0) {
+        fprintf(
+            stderr, "Max frame ticks must be positive, using the default\n"
+        );
+        configuration->max_frame_ticks = DEFAULT_MAX_FRAME_TICKS;
+    }
+
+    if (configuration->scroll_speed < 0) {
+        fprintf(stderr, "Scroll speed cannot be negative, not scrolling\n");
+        configuration->scroll_speed = 0.0;
+    }
+
+    if (configuration->ball_count < 0) {
+        fprintf(stderr, "Ball count cannot be negative, using none\n");
+        configuration->ball_count = 0;
+    }
+
+    if (configuration->worker_count < 1
+        || configuration->worker_count > TASK_SCHEDULER_MAX_WORKERS) {
+        fprintf(
+            stderr,
+            "Worker count must be between 1 and %d, using the default\n",
+            TASK_SCHEDULER_MAX_WORKERS
+        );
+        configuration->worker_count = DEFAULT_WORKER_COUNT;
+    }
+
+    fclose(config_file);
+    toml_free(parse_result);
+    return true;
+}
@@ -0,0 +1,171 @@
+#include <breakout/endless.h>
+#include <breakout/game.h>
+#include <math.h>
+
+/* Mixes a generated row number and a column into the bits that decide the
+ * brick, the same row always comes out the same */
+static uint32_t HashBrick(uint32_t row, uint32_t column) {
+    uint32_t hash = row * 0x9e3779b1u ^ column * 0x85ebca6bu;
+
+    hash ^= hash >> 16;
+    hash *= 0x7feb352du;
+    hash ^= hash >> 15;
+    hash *= 0x846ca68bu;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+static void SetBrickActive(
+    Configuration *config, int brick_index, bool active
+) {
+    BrickStore *bricks = &config->bricks;
+    b2ShapeId   shape_id = bricks->shape_ids[brick_index];
+    b2Filter    filter = b2Shape_GetFilter(shape_id);
+    uint64_t    mask_bits = active ? b2DefaultFilter().maskBits : 0;
+
+    SetBrickLive(bricks, brick_index, active);
+
+    // NOTE: a new filter resets the shape's broadphase proxy, slots that stay
+    // as they were are left alone
+    if (filter.maskBits != mask_bits) {
+        filter.maskBits = mask_bits;
+        b2Shape_SetFilter(shape_id, filter);
+    }
+}
+
+static void GenerateRow(Configuration *config, int row) {
+    EndlessField *endless = &config->endless;
+    BrickStore   *bricks = &config->bricks;
+    int           columns = (int)config->bricks_in_row;
+    uint32_t      number = endless->generated_rows++;
+    uint32_t      max_hit_points = 1 + number / ENDLESS_ROWS_PER_HIT_POINT;
+    Color         color = config->rows_colors[number % ROWS_NUMBER];
+
+    if (max_hit_points > ENDLESS_MAX_HIT_POINTS) {
+        max_hit_points = ENDLESS_MAX_HIT_POINTS;
+    }
+
+    for (int column = 0; column < columns; column++) {
+        int      brick_index = row * columns + column;
+        uint32_t hash = HashBrick(number, (uint32_t)column);
+
+        bricks->colors[brick_index] = color;
+        bricks->hit_points[brick_index] = 1 + (hash >> 8) % max_hit_points;
+        SetBrickActive(
+            config, brick_index, (hash & 0xff) < ENDLESS_BRICK_CHANCE
+        );
+    }
+}
+
+int GetEndlessRowCount(Configuration *config) {
+    CalculateBrickDimensions(config);
+
+    float pitch = config->brick_height + BRICKS_PADDING;
+
+    // NOTE: a row only leaves once it is fully below the screen, the rows
+    // above it cover the screen when it is misaligned with the pitch
+    return (int)ceilf(HEIGHT / pitch) + 2;
+}
+
+void CreateEndlessBricks(Configuration *config) {
+    EndlessField *endless = &config->endless;
+    BrickStore   *bricks = &config->bricks;
+    int           columns = (int)config->bricks_in_row;
+    int           row_count = GetEndlessRowCount(config);
+
+    *endless = (EndlessField){
+        .row_count = row_count,
+        .row_pitch = config->brick_height + BRICKS_PADDING,
+        .row_y = ARENA_ALLOC_ARRAY(&config->level_arena, float, row_count),
+    };
+
+    // NOTE: rows are uniform, nothing needs the grid to find bricks
+    config->brick_grid = (BrickGrid){ 0 };
+
+    for (int row = 0; row < row_count; row++) {
+        float y = BRICKS_MARGIN
+                + (ROWS_NUMBER - row_count + row) * endless->row_pitch;
+
+        b2BodyDef row_body_def = b2DefaultBodyDef();
+        row_body_def.type = b2_kinematicBody;
+        row_body_def.position = (b2Vec2){ 0, PIXELS_TO_WORLD(y) };
+        row_body_def.linearVelocity =
+            (b2Vec2){ 0, PIXELS_TO_WORLD(config->scroll_speed) };
+        // NOTE: a slow scroll is below the sleep threshold
+        row_body_def.enableSleep = false;
+
+        bricks->chunk_body_ids[row] =
+            b2CreateBody(config->world_id, &row_body_def);
+        endless->row_y[row] = y;
+
+        for (int column = 0; column < columns; column++) {
+            int brick_index = row * columns + column;
+
+            bricks->positions[brick_index] = (Vector2){
+                BRICKS_MARGIN
+                    + column * (config->brick_width + config->brick_padding),
+                y,
+            };
+            bricks->sizes[brick_index] =
+                (Vector2){ config->brick_width, config->brick_height };
+
+            SpawnBrick(config, brick_index);
+        }
+    }
+
+    // NOTE: generated bottom up, the order in which rows come into play
+    for (int row = row_count - 1; row >= 0; row--) {
+        GenerateRow(config, row);
+    }
+}
+
+void ScrollEndlessBricks(Configuration *config) {
+    EndlessField *endless = &config->endless;
+    BrickStore   *bricks = &config->bricks;
+    int           columns = (int)config->bricks_in_row;
+    int           row_count = endless->row_count;
+
+    for (int row = 0; row < row_count; row++) {
+        b2Vec2 position = b2Body_GetPosition(bricks->chunk_body_ids[row]);
+        endless->row_y[row] = WORLD_TO_PIXELS(position.y);
+    }
+
+    int bottom_row = (endless->top_row + row_count - 1) % row_count;
+
+    for (int recycled = 0;
+         recycled < row_count && endless->row_y[bottom_row] >= HEIGHT;
+         recycled++) {
+        float y = endless->row_y[endless->top_row] - endless->row_pitch;
+
+        // NOTE: the body keeps its velocity through the teleport
+        b2Body_SetTransform(
+            bricks->chunk_body_ids[bottom_row],
+            (b2Vec2){ 0, PIXELS_TO_WORLD(y) },
+            b2Rot_identity
+        );
+        endless->row_y[bottom_row] = y;
+        GenerateRow(config, bottom_row);
+
+        endless->top_row = bottom_row;
+        bottom_row = (bottom_row + row_count - 1) % row_count;
+    }
+
+    for (int row = 0; row < row_count; row++) {
+        for (int column = 0; column < columns; column++) {
+            bricks->positions[row * columns + column].y = endless->row_y[row];
+        }
+    }
+}
+
+void RetireEndlessBrick(Configuration *config, int brick_index) {
+    SetBrickActive(config, brick_index, false);
+    config->endless.destroyed_count++;
+}
+
+void SetEndlessScrollSpeed(Configuration *config) {
+    b2Vec2 velocity = { 0, PIXELS_TO_WORLD(config->scroll_speed) };
+
+    for (int row = 0; row < config->endless.row_count; row++) {
+        b2Body_SetLinearVelocity(config->bricks.chunk_body_ids[row], velocity);
+    }
+}
@@ -0,0 +1,102 @@
+#include <breakout/file_map.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MapFile(FileMap *map, const char *path) {
+    *map = (FileMap){ 0 };
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        NULL
+    );
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!data) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    map->data = data;
+    map->size = (size_t)size.QuadPart;
+    map->file = file;
+    map->mapping = mapping;
+#else
+    int descriptor = open(path, O_RDONLY);
+
+    if (descriptor < 0) {
+        return false;
+    }
+
+    struct stat status;
+
+    if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+        close(descriptor);
+        return false;
+    }
+
+    void *data =
+        mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+    // NOTE: the mapping keeps the file alive on its own
+    close(descriptor);
+
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    map->data = data;
+    map->size = (size_t)status.st_size;
+#endif
+
+    return true;
+}
+
+void UnmapFile(FileMap *map) {
+    if (!map->data) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(map->data);
+    CloseHandle(map->mapping);
+    CloseHandle(map->file);
+#else
+    munmap((void *)map->data, map->size);
+#endif
+
+    *map = (FileMap){ 0 };
+}
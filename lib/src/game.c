@@ -0,0 +1,744 @@
+#include <breakout/game.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// NOTE: swarm balls launch at fractional multiples of the golden ratio over
+// this spread around the initial velocity, so no two start out in step
+#define SWARM_ANGLE_STEP   0.618034f
+#define SWARM_ANGLE_SPREAD (PI / 3)
+
+Configuration DefaultConfiguration(void) {
+    return (Configuration){
+        .bricks_in_row = BRICKS_IN_ROW,
+        .tick_rate = DEFAULT_TICK_RATE,
+        .max_frame_ticks = DEFAULT_MAX_FRAME_TICKS,
+        .worker_count = DEFAULT_WORKER_COUNT,
+        .rows_colors = {RED, ORANGE, YELLOW, GREEN, BLUE, PURPLE, PINK, MAROON},
+        .background_color = BLACK,
+        .player = {
+            .movement_speed = 400.f,
+            .width = 100,
+            .height = 15,
+            .color = DARKBLUE,
+        },
+        .ball = {
+            .color = WHITE,
+            .radius = 8.f,
+            .max_speed = PIXELS_TO_WORLD(400.f),
+            .min_speed_multiplier = 0.8f,
+            .initial_velocity = {PIXELS_TO_WORLD(150.f), PIXELS_TO_WORLD(300.f)},
+        },
+        .physics = &BOX2D_PHYSICS,
+        .world_id = b2_nullWorldId,
+    };
+}
+
+/* Sizes the brick store for the level, the endless pool or the grid layout
+ * and creates the bricks in it */
+static void CreateBrickField(Configuration *config) {
+    int count = (int)(config->bricks_in_row * ROWS_NUMBER);
+    int chunk_size = BRICK_STORE_CHUNK_SIZE;
+
+    if (config->level) {
+        count = config->level->brick_count;
+    } else if (config->scroll_speed > 0) {
+        // NOTE: one chunk body per row, the rows move independently
+        count = GetEndlessRowCount(config) * (int)config->bricks_in_row;
+        chunk_size = (int)config->bricks_in_row;
+    }
+
+    CreateBrickStore(
+        &config->bricks, count, chunk_size, &config->level_arena
+    );
+    CreateBricks(config);
+}
+
+/* The rows of endless mode are Box2D bodies, the other backends only play
+ * fixed fields */
+static bool CanScroll(const Configuration *config) {
+    return config->physics->kind == PHYSICS_BOX2D;
+}
+
+void InitGame(Configuration *config) {
+    if (config->scroll_speed > 0 && !CanScroll(config)) {
+        fprintf(
+            stderr,
+            "Endless mode needs the %s physics, using it\n",
+            BOX2D_PHYSICS.name
+        );
+        config->physics = &BOX2D_PHYSICS;
+    }
+
+    config->physics->create_world(config);
+
+    InitArena(&config->level_arena, ARENA_DEFAULT_BLOCK_SIZE);
+
+    CreateBrickField(config);
+    CreateSwarmBalls(config);
+
+    config->physics->set_ball_velocity(config, config->ball.initial_velocity);
+
+    config->ball.previous_position = GetBallPosition(config);
+    config->player.previous_position = GetPlayerPosition(config);
+}
+
+void ShutdownGame(Configuration *config) {
+    // NOTE: the backend takes every brick with it and the level arena holds
+    // the brick store and grid, nothing is released one by one
+    config->physics->destroy_world(config);
+
+    FreeArena(&config->level_arena);
+    FreeBallSwarm(&config->swarm);
+    config->bricks = (BrickStore){ 0 };
+    config->brick_grid = (BrickGrid){ 0 };
+    config->endless = (EndlessField){ 0 };
+}
+
+bool ApplyConfiguration(Configuration *config, const Configuration *reloaded) {
+    config->tick_rate = reloaded->tick_rate;
+    config->max_frame_ticks = reloaded->max_frame_ticks;
+    config->player.movement_speed = reloaded->player.movement_speed;
+    config->ball.min_speed_multiplier = reloaded->ball.min_speed_multiplier;
+
+    if (reloaded->worker_count != config->worker_count) {
+        fprintf(stderr, "worker_count only changes on restart, skipping...\n");
+    }
+
+    if (reloaded->physics != config->physics) {
+        fprintf(stderr, "physics only changes on restart, skipping...\n");
+    }
+
+    if (reloaded->player.width != config->player.width
+        || reloaded->player.height != config->player.height
+        || reloaded->ball.radius != config->ball.radius) {
+        config->player.width = reloaded->player.width;
+        config->player.height = reloaded->player.height;
+        config->ball.radius = reloaded->ball.radius;
+        config->physics->resize(config);
+    }
+
+    // NOTE: swarm balls read the radius every tick, only their number needs
+    // a new swarm
+    if (reloaded->ball_count != config->ball_count) {
+        config->ball_count = reloaded->ball_count;
+        FreeBallSwarm(&config->swarm);
+        CreateSwarmBalls(config);
+    }
+
+    // NOTE: a level file fixes the layout, bricks_in_row and scroll_speed do
+    // not apply
+    if (config->level) {
+        return false;
+    }
+
+    bool was_endless = config->scroll_speed > 0;
+    config->scroll_speed = reloaded->scroll_speed;
+
+    if (config->scroll_speed > 0 && !CanScroll(config)) {
+        fprintf(
+            stderr,
+            "Endless mode needs the %s physics, skipping...\n",
+            BOX2D_PHYSICS.name
+        );
+        config->scroll_speed = 0.0;
+    }
+
+    // NOTE: a new speed only changes the rows' velocity, turning endless mode
+    // on or off needs another brick store
+    if (reloaded->bricks_in_row == config->bricks_in_row
+        && was_endless == (config->scroll_speed > 0)) {
+        if (config->endless.row_count > 0) {
+            SetEndlessScrollSpeed(config);
+        }
+        return false;
+    }
+
+    DestroyAllBricks(config);
+    ResetArena(&config->level_arena);
+
+    config->bricks_in_row = reloaded->bricks_in_row;
+    CreateBrickField(config);
+    return true;
+}
+
+void ProcessInput(Configuration *config, const GameInput *input) {
+    Player *player = &config->player;
+
+    b2Vec2 velocity = b2Vec2_zero;
+
+    if (input->move_left) {
+        velocity.x = -PIXELS_TO_WORLD(player->movement_speed);
+    }
+
+    if (input->move_right) {
+        velocity.x = PIXELS_TO_WORLD(player->movement_speed);
+    }
+
+    if (input->reset_ball) {
+        ResetBall(config);
+    }
+
+    config->physics->set_player_velocity(config, velocity);
+}
+
+void CalculateBrickDimensions(Configuration *config) {
+    double available_width = WIDTH - BRICKS_MARGIN * 2;
+
+    config->brick_padding = BRICKS_PADDING;
+
+    // NOTE: dense rows would end up with bricks narrower than the gaps (or of
+    // negative width), those split the row evenly between bricks and gaps
+    if (available_width - (config->bricks_in_row - 1) * BRICKS_PADDING
+        < config->bricks_in_row * BRICKS_PADDING) {
+        config->brick_padding =
+            available_width / (config->bricks_in_row * 2 - 1);
+    }
+
+    double horizontal_padding =
+        (config->bricks_in_row - 1) * config->brick_padding;
+    config->brick_width =
+        (available_width - horizontal_padding) / config->bricks_in_row;
+
+    double available_height = BRICKS_AREA_HEIGHT;
+    double vertical_padding = (ROWS_NUMBER - 1) * BRICKS_PADDING;
+    config->brick_height = (available_height - vertical_padding) / ROWS_NUMBER;
+}
+
+void ClampPlayerMovement(Configuration *config) {
+    b2Vec2 position = GetPlayerPosition(config);
+
+    double half_width = PIXELS_TO_WORLD(config->player.width / 2);
+
+    if (position.x - half_width < 0.f) {
+        position.x = half_width;
+        config->physics->set_player_position(config, position);
+    }
+    if (position.x + half_width > PIXELS_TO_WORLD(WIDTH)) {
+        position.x = PIXELS_TO_WORLD(WIDTH) - half_width;
+        config->physics->set_player_position(config, position);
+    }
+}
+
+void ClampBallMovement(Configuration *config) {
+    b2Vec2 velocity = GetBallVelocity(config);
+    double current_speed =
+        sqrtf(velocity.x * velocity.x + velocity.y * velocity.y);
+
+    if (current_speed > config->ball.max_speed) {
+        double scale = config->ball.max_speed / current_speed;
+        b2Vec2 clamped_velocity = { velocity.x * scale, velocity.y * scale };
+        config->physics->set_ball_velocity(config, clamped_velocity);
+
+        RecordTelemetryEvent(
+            config->telemetry,
+            (TelemetryEvent){
+                .type = TELEMETRY_SPEED_CLAMPED,
+                .speed = current_speed,
+                .corrected_speed = config->ball.max_speed,
+            }
+        );
+    } else if (current_speed > 0.1f
+               && current_speed < config->ball.max_speed * 0.5f) {
+        double target_speed =
+            config->ball.max_speed * config->ball.min_speed_multiplier;
+        double scale = target_speed / current_speed;
+        b2Vec2 boosted_velocity = { velocity.x * scale, velocity.y * scale };
+        config->physics->set_ball_velocity(config, boosted_velocity);
+
+        RecordTelemetryEvent(
+            config->telemetry,
+            (TelemetryEvent){
+                .type = TELEMETRY_SPEED_BOOSTED,
+                .speed = current_speed,
+                .corrected_speed = target_speed,
+            }
+        );
+    }
+}
+
+b2Vec2 GetBallStartPosition(void) {
+    return (b2Vec2){ PIXELS_TO_WORLD((double)WIDTH / 2),
+                     PIXELS_TO_WORLD(HEIGHT - (double)HEIGHT / 2) };
+}
+
+b2Vec2 GetPlayerStartPosition(void) {
+    return (b2Vec2){ PIXELS_TO_WORLD((double)WIDTH / 2),
+                     PIXELS_TO_WORLD(HEIGHT - (double)HEIGHT / 5) };
+}
+
+void ResetBall(Configuration *config) {
+    b2Vec2 restart_position = GetBallStartPosition();
+    config->physics->set_ball_position(config, restart_position);
+    config->physics->set_ball_velocity(config, config->ball.initial_velocity);
+
+    // NOTE: teleport, there is nothing to interpolate from
+    config->ball.previous_position = restart_position;
+}
+
+void CreateSwarmBalls(Configuration *config) {
+    if (config->ball_count <= 0) {
+        return;
+    }
+
+    CreateBallSwarm(&config->swarm, (int)config->ball_count);
+
+    for (int i = 0; i < config->swarm.count; i++) {
+        ResetSwarmBall(config, i);
+    }
+}
+
+void ResetSwarmBall(Configuration *config, int ball_index) {
+    BallSwarm *swarm = &config->swarm;
+    float      angle = (fmodf(ball_index * SWARM_ANGLE_STEP, 1.f) - 0.5f)
+                * SWARM_ANGLE_SPREAD;
+    float      velocity_x = WORLD_TO_PIXELS(config->ball.initial_velocity.x);
+    float      velocity_y = WORLD_TO_PIXELS(config->ball.initial_velocity.y);
+
+    swarm->position_x[ball_index] = (float)WIDTH / 2;
+    swarm->position_y[ball_index] = (float)HEIGHT / 2;
+    swarm->velocity_x[ball_index] =
+        velocity_x * cosf(angle) - velocity_y * sinf(angle);
+    swarm->velocity_y[ball_index] =
+        velocity_x * sinf(angle) + velocity_y * cosf(angle);
+
+    // NOTE: teleport, there is nothing to interpolate from
+    swarm->previous_x[ball_index] = swarm->position_x[ball_index];
+    swarm->previous_y[ball_index] = swarm->position_y[ball_index];
+}
+
+void SpawnBrick(Configuration *config, int brick_index) {
+    SetBrickLive(&config->bricks, brick_index, true);
+    config->physics->spawn_brick(config, brick_index);
+}
+
+void DestroyBrick(Configuration *config, int brick_index) {
+    BrickStore *bricks = &config->bricks;
+
+    if (config->endless.row_count > 0) {
+        RetireEndlessBrick(config, brick_index);
+        return;
+    }
+
+    SetBrickLive(bricks, brick_index, false);
+    config->physics->destroy_brick(config, brick_index);
+
+    RemoveBrickFromGrid(
+        &config->brick_grid,
+        bricks->positions[brick_index],
+        bricks->sizes[brick_index]
+    );
+}
+
+static void CreateLevelBricks(Configuration *config) {
+    BrickStore *bricks = &config->bricks;
+    // NOTE: in double, the sizes of large bricks can add up past a float
+    double      total_width = 0.0;
+    double      total_height = 0.0;
+
+    for (int i = 0; i < bricks->count; i++) {
+        LevelBrick brick = GetLevelBrick(config->level, i);
+
+        bricks->positions[i] = brick.position;
+        bricks->sizes[i] = brick.size;
+        bricks->colors[i] = brick.color;
+        bricks->hit_points[i] = brick.hit_points;
+        total_width += brick.size.x;
+        total_height += brick.size.y;
+
+        SpawnBrick(config, i);
+    }
+
+    if (bricks->count == 0) {
+        return;
+    }
+
+    // NOTE: bricks differ in size, an average sized brick touches at most 2x2
+    // cells and larger ones span a few more
+    BuildBrickGrid(
+        &config->brick_grid,
+        bricks->positions,
+        bricks->sizes,
+        bricks->count,
+        (Vector2){ total_width / bricks->count,
+                   total_height / bricks->count },
+        &config->level_arena
+    );
+}
+
+void CreateBricks(Configuration *config) {
+    config->endless = (EndlessField){ 0 };
+
+    if (config->level) {
+        CreateLevelBricks(config);
+        return;
+    }
+
+    if (config->scroll_speed > 0) {
+        CreateEndlessBricks(config);
+        return;
+    }
+
+    CalculateBrickDimensions(config);
+
+    BrickStore *bricks = &config->bricks;
+
+    for (int j = 0; j < ROWS_NUMBER; j++) {
+        for (int i = 0; i < config->bricks_in_row; i++) {
+            int      brick_index = i + j * config->bricks_in_row;
+            Vector2 *position = &bricks->positions[brick_index];
+
+            position->x = BRICKS_MARGIN
+                        + i * (config->brick_width + config->brick_padding);
+            position->y =
+                BRICKS_MARGIN + j * (config->brick_height + BRICKS_PADDING);
+
+            bricks->sizes[brick_index] =
+                (Vector2){ config->brick_width, config->brick_height };
+            bricks->colors[brick_index] = config->rows_colors[j];
+            bricks->hit_points[brick_index] = 1;
+
+            SpawnBrick(config, brick_index);
+        }
+    }
+
+    // NOTE: one cell per brick pitch, so a ball touches at most 2x2 cells
+    BuildBrickGrid(
+        &config->brick_grid,
+        bricks->positions,
+        bricks->sizes,
+        bricks->count,
+        (Vector2){ config->brick_width + config->brick_padding,
+                   config->brick_height + BRICKS_PADDING },
+        &config->level_arena
+    );
+}
+
+static void DestroyQueuedBricks(Configuration *config) {
+    BrickStore *bricks = &config->bricks;
+
+    for (int i = 0; i < bricks->destroy_count; i++) {
+        DestroyBrick(config, bricks->destroy_queue[i]);
+
+        RecordTelemetryEvent(
+            config->telemetry,
+            (TelemetryEvent){
+                .type = TELEMETRY_BRICK_DESTROYED,
+                .brick_index = bricks->destroy_queue[i],
+            }
+        );
+    }
+
+    bricks->destroy_count = 0;
+}
+
+/* Ball event for the telemetry, with the ball's offset from the paddle */
+static TelemetryEvent GetBallEvent(
+    const Configuration *config, TelemetryEventType type
+) {
+    b2Vec2 ball = GetBallPosition(config);
+    b2Vec2 player = GetPlayerPosition(config);
+
+    return (TelemetryEvent){
+        .type = type,
+        .offset = WORLD_TO_PIXELS(ball.x - player.x),
+        .speed = b2Length(GetBallVelocity(config)),
+    };
+}
+
+void CheckBallBrickCollisions(Configuration *config) {
+    BrickStore        *bricks = &config->bricks;
+    const PhysicsHits *hits = &config->hits;
+
+    if (hits->paddle && config->telemetry) {
+        RecordTelemetryEvent(
+            config->telemetry, GetBallEvent(config, TELEMETRY_PADDLE_HIT)
+        );
+    }
+
+    // NOTE: brick collision stays in place until the batch below, so indices
+    // are gathered first and the bricks destroyed afterwards
+    for (int i = 0; i < hits->brick_count; i++) {
+        int brick_index = hits->bricks[i];
+
+        if (IsBrickLive(bricks, brick_index)
+            && --bricks->hit_points[brick_index] == 0) {
+            QueueBrickDestruction(bricks, brick_index);
+        }
+    }
+
+    DestroyQueuedBricks(config);
+}
+
+void DestroyAllBricks(Configuration *config) {
+    BrickStore *bricks = &config->bricks;
+
+    config->physics->destroy_all_bricks(config);
+
+    for (int i = NextLiveBrick(bricks, 0); i >= 0;
+         i = NextLiveBrick(bricks, i + 1)) {
+        SetBrickLive(bricks, i, false);
+    }
+}
+
+/* Live bricks gathered around one swarm ball, as edge arrays for
+ * TestCircleRectangles */
+typedef struct BrickBatch {
+    float left[BALL_SWARM_MAX_RECTANGLES];
+    float top[BALL_SWARM_MAX_RECTANGLES];
+    float right[BALL_SWARM_MAX_RECTANGLES];
+    float bottom[BALL_SWARM_MAX_RECTANGLES];
+    int   bricks[BALL_SWARM_MAX_RECTANGLES];
+    int   count;
+} BrickBatch;
+
+/* Tests and empties the batch, returns the first brick hit or -1 */
+static int TestBrickBatch(BrickBatch *batch, float x, float y, float radius) {
+    uint32_t hits = TestCircleRectangles(
+        x,
+        y,
+        radius,
+        batch->left,
+        batch->top,
+        batch->right,
+        batch->bottom,
+        batch->count
+    );
+
+    batch->count = 0;
+
+    for (int i = 0; hits != 0; i++, hits >>= 1) {
+        if (hits & 1) {
+            return batch->bricks[i];
+        }
+    }
+
+    return -1;
+}
+
+/* First live brick the swarm ball overlaps, -1 if there is none */
+static int FindSwarmBallBrick(
+    const Configuration *config, BrickBatch *batch, float x, float y
+) {
+    const BrickStore *bricks = &config->bricks;
+    const BrickGrid  *grid = &config->brick_grid;
+    float             radius = (float)config->ball.radius;
+    Rectangle area = { x - radius, y - radius, radius * 2, radius * 2 };
+
+    int first_column, first_row, last_column, last_row;
+
+    if (!GetBrickGridCells(
+            grid, area, &first_column, &first_row, &last_column, &last_row
+        )) {
+        return -1;
+    }
+
+    batch->count = 0;
+
+    for (int row = first_row; row <= last_row; row++) {
+        if (grid->row_live[row] == 0) {
+            continue;
+        }
+
+        for (int column = first_column; column <= last_column; column++) {
+            int cell = row * grid->columns + column;
+
+            for (int i = grid->cell_start[cell]; i < grid->cell_start[cell + 1];
+                 i++) {
+                int brick_index = grid->cell_bricks[i];
+
+                if (!IsBrickLive(bricks, brick_index)) {
+                    continue;
+                }
+
+                Vector2 position = bricks->positions[brick_index];
+                Vector2 size = bricks->sizes[brick_index];
+
+                // NOTE: a brick over two cells may be gathered twice, the
+                // first hit ends the search so it is never counted twice
+                batch->left[batch->count] = position.x;
+                batch->top[batch->count] = position.y;
+                batch->right[batch->count] = position.x + size.x;
+                batch->bottom[batch->count] = position.y + size.y;
+                batch->bricks[batch->count++] = brick_index;
+
+                if (batch->count == BALL_SWARM_MAX_RECTANGLES) {
+                    int hit = TestBrickBatch(batch, x, y, radius);
+
+                    if (hit >= 0) {
+                        return hit;
+                    }
+                }
+            }
+        }
+    }
+
+    return batch->count > 0 ? TestBrickBatch(batch, x, y, radius) : -1;
+}
+
+static void CollideSwarmWithBricks(Configuration *config) {
+    BallSwarm       *swarm = &config->swarm;
+    BrickStore      *bricks = &config->bricks;
+    const BrickGrid *grid = &config->brick_grid;
+    float            radius = (float)config->ball.radius;
+    BrickBatch       batch;
+
+    if (grid->rows == 0) {
+        return;
+    }
+
+    // NOTE: most balls are below the bricks, only those in reach are tested
+    int selected_count = SelectBallsBetween(
+        swarm,
+        grid->origin.y - radius,
+        grid->origin.y + grid->rows * grid->cell_size.y + radius
+    );
+
+    for (int i = 0; i < selected_count; i++) {
+        int   ball_index = swarm->selected[i];
+        float x = swarm->position_x[ball_index];
+        float y = swarm->position_y[ball_index];
+        int   brick_index = FindSwarmBallBrick(config, &batch, x, y);
+
+        if (brick_index < 0) {
+            continue;
+        }
+
+        Vector2 position = bricks->positions[brick_index];
+        Vector2 size = bricks->sizes[brick_index];
+        float   center_x = position.x + size.x / 2;
+        float   center_y = position.y + size.y / 2;
+
+        // NOTE: bounce off the side the ball is the least deep into
+        float overlap_x = size.x / 2 + radius - fabsf(x - center_x);
+        float overlap_y = size.y / 2 + radius - fabsf(y - center_y);
+        float velocity_x = fabsf(swarm->velocity_x[ball_index]);
+        float velocity_y = fabsf(swarm->velocity_y[ball_index]);
+
+        if (overlap_x < overlap_y) {
+            swarm->velocity_x[ball_index] =
+                x < center_x ? -velocity_x : velocity_x;
+        } else {
+            swarm->velocity_y[ball_index] =
+                y < center_y ? -velocity_y : velocity_y;
+        }
+
+        if (--bricks->hit_points[brick_index] == 0) {
+            QueueBrickDestruction(bricks, brick_index);
+        }
+    }
+
+    DestroyQueuedBricks(config);
+}
+
+void TickBallSwarm(Configuration *config) {
+    BallSwarm *swarm = &config->swarm;
+    float      radius = (float)config->ball.radius;
+
+    memcpy(swarm->previous_x, swarm->position_x, sizeof(float) * swarm->count);
+    memcpy(swarm->previous_y, swarm->position_y, sizeof(float) * swarm->count);
+
+    MoveBalls(swarm, 1.f / config->tick_rate, radius, WIDTH);
+
+    b2Vec2    player = GetPlayerPosition(config);
+    Rectangle paddle = {
+        WORLD_TO_PIXELS(player.x) - config->player.width / 2,
+        WORLD_TO_PIXELS(player.y) - config->player.height / 2,
+        config->player.width,
+        config->player.height,
+    };
+
+    BounceBallsOffRectangle(swarm, radius, paddle);
+    CollideSwarmWithBricks(config);
+    ClampBallSpeeds(
+        swarm,
+        WORLD_TO_PIXELS(config->ball.max_speed),
+        config->ball.min_speed_multiplier
+    );
+
+    int lost_count = SelectBallsBetween(swarm, HEIGHT, INFINITY);
+
+    for (int i = 0; i < lost_count; i++) {
+        ResetSwarmBall(config, swarm->selected[i]);
+    }
+}
+
+bool TickGame(Configuration *config, const GameInput *input) {
+    config->ball.previous_position = GetBallPosition(config);
+    config->player.previous_position = GetPlayerPosition(config);
+
+    Profiler *profiler = config->profiler;
+    uint64_t  sample = BeginProfileSample(profiler);
+
+    ProcessInput(config, input);
+    sample = EndProfileSample(profiler, PROFILE_PHASE_INPUT, sample);
+
+    config->physics->step(config, 1.0 / config->tick_rate);
+    sample = EndProfileSample(profiler, PROFILE_PHASE_STEP, sample);
+
+    CheckBallBrickCollisions(config);
+
+    if (config->endless.row_count > 0) {
+        ScrollEndlessBricks(config);
+    }
+    sample = EndProfileSample(profiler, PROFILE_PHASE_COLLISIONS, sample);
+
+    ClampPlayerMovement(config);
+    ClampBallMovement(config);
+    sample = EndProfileSample(profiler, PROFILE_PHASE_CLAMP, sample);
+
+    if (config->swarm.count > 0) {
+        TickBallSwarm(config);
+        EndProfileSample(profiler, PROFILE_PHASE_BALLS, sample);
+    }
+
+    b2Vec2 bp = GetBallPosition(config);
+    bool   ball_lost = bp.y >= PIXELS_TO_WORLD(HEIGHT);
+
+    if (ball_lost) {
+        RecordTelemetryEvent(
+            config->telemetry, GetBallEvent(config, TELEMETRY_BALL_LOST)
+        );
+        ResetBall(config);
+    }
+
+    if (config->recorder) {
+        RecordReplayTick(config->recorder, config, input);
+    }
+
+    AdvanceTelemetryTick(config->telemetry);
+    return ball_lost;
+}
+
+GameClock CreateGameClock(const Configuration *config) {
+    return (GameClock){
+        .time_step = 1.0 / config->tick_rate,
+        .accumulator = 0.0,
+        .max_frame_ticks = config->max_frame_ticks,
+    };
+}
+
+int AdvanceGame(
+    Configuration   *config,
+    GameClock       *clock,
+    const GameInput *input,
+    double           frame_time
+) {
+    clock->accumulator += frame_time;
+
+    int ticks = 0;
+
+    while (clock->accumulator >= clock->time_step) {
+        if (ticks >= clock->max_frame_ticks) {
+            clock->accumulator = fmod(clock->accumulator, clock->time_step);
+            break;
+        }
+
+        TickGame(config, input);
+        clock->accumulator -= clock->time_step;
+        ticks++;
+    }
+
+    return ticks;
+}
@@ -0,0 +1,105 @@
+#include <breakout/game_instance.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// NOTE: the ball leaves at up to this angle from the configured direction
+#define SEED_MAX_ANGLE 0.5f
+
+struct GameInstance {
+    Configuration config;
+    GameState     state;
+    int           bricks_total;
+};
+
+static uint32_t NextRandom(uint32_t *state) {
+    // NOTE: xorshift32, deterministic across platforms unlike rand()
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static b2Vec2 SeedBallVelocity(b2Vec2 velocity, uint32_t seed) {
+    uint32_t state = seed;
+    float    unit = (NextRandom(&state) & 0xffffff) / (float)0xffffff;
+    float    angle = (unit * 2.f - 1.f) * SEED_MAX_ANGLE;
+    float    c = cosf(angle);
+    float    s = sinf(angle);
+
+    b2Vec2 rotated = { velocity.x * c - velocity.y * s,
+                       velocity.x * s + velocity.y * c };
+
+    if (NextRandom(&state) & 1) {
+        rotated.x = -rotated.x;
+    }
+
+    return rotated;
+}
+
+GameInstance *CreateGameInstance(const Configuration *config, uint32_t seed) {
+    GameInstance *instance =
+        MemoryCalloc(MEMORY_GAME, 1, sizeof(GameInstance));
+
+    // NOTE: memcpy, the configuration has const members and cannot be assigned
+    memcpy(&instance->config, config, sizeof(Configuration));
+    instance->config.scheduler = NULL;
+    instance->config.recorder = NULL;
+    instance->config.profiler = NULL;
+    instance->config.telemetry = NULL;
+
+    if (seed != 0) {
+        instance->config.ball.initial_velocity =
+            SeedBallVelocity(config->ball.initial_velocity, seed);
+    }
+
+    InitGame(&instance->config);
+
+    instance->bricks_total = CountLiveBricks(&instance->config.bricks);
+    instance->state.bricks_left = instance->bricks_total;
+
+    return instance;
+}
+
+void DestroyGameInstance(GameInstance *instance) {
+    ShutdownGame(&instance->config);
+    MemoryFree(instance);
+}
+
+long StepGameInstance(
+    GameInstance *instance,
+    long          ticks,
+    InputSource   input_source,
+    void         *input_user_data
+) {
+    Configuration *config = &instance->config;
+    GameState     *state = &instance->state;
+
+    long ticks_run = 0;
+
+    while (ticks_run < ticks && !state->cleared) {
+        GameInput input = input_source(config, state->tick, input_user_data);
+
+        if (TickGame(config, &input)) {
+            state->balls_lost++;
+        }
+
+        state->bricks_left = CountLiveBricks(&config->bricks);
+        state->score = instance->bricks_total - state->bricks_left;
+        state->cleared = state->bricks_left == 0;
+        state->tick++;
+        ticks_run++;
+    }
+
+    return ticks_run;
+}
+
+GameState GetGameState(const GameInstance *instance) {
+    return instance->state;
+}
+
+const Configuration *GetGameConfiguration(const GameInstance *instance) {
+    return &instance->config;
+}
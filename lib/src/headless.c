@@ -0,0 +1,300 @@
+#include <breakout/headless.h>
+#include <breakout/clock.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+
+#define AUTOPILOT_DEAD_ZONE 4.f
+
+HeadlessOptions DefaultHeadlessOptions(void) {
+    return (HeadlessOptions){
+        .games = 1,
+        .max_ticks = HEADLESS_DEFAULT_TICKS,
+        .input_source = AutopilotInput,
+        .input_user_data = NULL,
+    };
+}
+
+GameInput AutopilotInput(const Configuration *config, long tick, void *user_data) {
+    (void)tick;
+    (void)user_data;
+
+    b2Vec2 ball_position = GetBallPosition(config);
+    b2Vec2 player_position = GetPlayerPosition(config);
+
+    double offset = WORLD_TO_PIXELS(ball_position.x - player_position.x);
+
+    return (GameInput){
+        .move_left = offset < -AUTOPILOT_DEAD_ZONE,
+        .move_right = offset > AUTOPILOT_DEAD_ZONE,
+    };
+}
+
+GameInput ScriptedInput(const Configuration *config, long tick, void *user_data) {
+    (void)config;
+
+    const InputScript *script = user_data;
+    size_t             length = strlen(script->moves);
+
+    if (length == 0) {
+        return (GameInput){ 0 };
+    }
+
+    long ticks_per_move =
+        script->ticks_per_move > 0 ? script->ticks_per_move : 1;
+    char move = script->moves[(tick / ticks_per_move) % length];
+
+    return (GameInput){
+        .move_left = move == 'L',
+        .move_right = move == 'R',
+        .reset_ball = move == 'S' && tick % ticks_per_move == 0,
+    };
+}
+
+HeadlessReport RunHeadless(
+    Configuration *config, const HeadlessOptions *options
+) {
+    HeadlessReport report = {
+        .worker_count = config->scheduler
+                          ? GetTaskSchedulerWorkerCount(config->scheduler)
+                          : 1,
+        .physics = config->physics->name,
+    };
+
+    double start = GetClockSeconds();
+
+    for (long game = 0; game < options->games; game++) {
+        InitGame(config);
+
+        int bricks_total = CountLiveBricks(&config->bricks);
+        int bricks_left = bricks_total;
+
+        for (long tick = 0; tick < options->max_ticks && bricks_left > 0;
+             tick++) {
+            GameInput input = options->input_source(
+                config, tick, options->input_user_data
+            );
+
+            if (TickGame(config, &input)) {
+                report.balls_lost++;
+            }
+
+            report.step_milliseconds +=
+                config->physics->get_step_milliseconds(config);
+
+            bricks_left = CountLiveBricks(&config->bricks);
+            report.ticks++;
+        }
+
+        // NOTE: endless rows are refilled, the live count says nothing there
+        report.bricks_destroyed += config->endless.row_count > 0
+                                     ? config->endless.destroyed_count
+                                     : bricks_total - bricks_left;
+        report.games++;
+
+        ShutdownGame(config);
+    }
+
+    report.seconds = GetClockSeconds() - start;
+    report.ticks_per_second =
+        report.seconds > 0.0 ? report.ticks / report.seconds : 0.0;
+
+    return report;
+}
+
+void PrintHeadlessReport(const HeadlessReport *report) {
+    printf("Physics:          %s\n", report->physics);
+    printf("Workers:          %ld\n", report->worker_count);
+    printf("Games:            %ld\n", report->games);
+    printf("Ticks:            %ld\n", report->ticks);
+    printf("Bricks destroyed: %ld\n", report->bricks_destroyed);
+    printf("Balls lost:       %ld\n", report->balls_lost);
+    printf("Elapsed:          %.3f s\n", report->seconds);
+    printf("Ticks/sec:        %.0f\n", report->ticks_per_second);
+    printf(
+        "Avg step:         %.4f ms\n",
+        report->ticks > 0 ? report->step_milliseconds / report->ticks : 0.0
+    );
+}
+
+static bool IsBounce(b2Vec2 before, b2Vec2 after) {
+    return (before.x < 0.f) != (after.x < 0.f)
+        || (before.y < 0.f) != (after.y < 0.f);
+}
+
+PhysicsComparison ComparePhysics(
+    const Configuration   *config,
+    const HeadlessOptions *options,
+    const PhysicsBackend  *candidate
+) {
+    // NOTE: memcpy, the configuration has const members and cannot be assigned
+    Configuration reference_config;
+    Configuration candidate_config;
+    memcpy(&reference_config, config, sizeof(Configuration));
+    memcpy(&candidate_config, config, sizeof(Configuration));
+
+    reference_config.physics = &BOX2D_PHYSICS;
+    candidate_config.physics = candidate;
+    reference_config.recorder = candidate_config.recorder = NULL;
+    reference_config.profiler = candidate_config.profiler = NULL;
+    reference_config.telemetry = candidate_config.telemetry = NULL;
+
+    PhysicsComparison comparison = {
+        .reference = BOX2D_PHYSICS.name,
+        .candidate = candidate->name,
+        .window_ticks = PHYSICS_COMPARE_SECONDS * config->tick_rate,
+        .diverged_tick = -1,
+    };
+
+    InitGame(&reference_config);
+    InitGame(&candidate_config);
+
+    float step_travel = config->ball.max_speed / config->tick_rate;
+    long  last_bounce_tick = -2;
+
+    for (long tick = 0; tick < comparison.window_ticks
+                        && CountLiveBricks(&reference_config.bricks) > 0;
+         tick++) {
+        GameInput input = options->input_source(
+            &reference_config, tick, options->input_user_data
+        );
+        b2Vec2 reference_before = GetBallVelocity(&reference_config);
+        b2Vec2 candidate_before = GetBallVelocity(&candidate_config);
+        bool   ball_lost = TickGame(&reference_config, &input);
+
+        TickGame(&candidate_config, &input);
+        comparison.ticks++;
+
+        b2Vec2 reference_velocity = GetBallVelocity(&reference_config);
+        b2Vec2 candidate_velocity = GetBallVelocity(&candidate_config);
+
+        if (!ball_lost && IsBounce(reference_before, reference_velocity)) {
+            comparison.bounces++;
+        }
+
+        if (ball_lost || IsBounce(reference_before, reference_velocity)
+            || IsBounce(candidate_before, candidate_velocity)) {
+            last_bounce_tick = tick;
+        }
+
+        b2Vec2 reference_ball = GetBallPosition(&reference_config);
+        b2Vec2 candidate_ball = GetBallPosition(&candidate_config);
+        float  distance = b2Length((b2Vec2){
+            reference_ball.x - candidate_ball.x,
+            reference_ball.y - candidate_ball.y,
+        });
+
+        b2Vec2 velocity_difference = {
+            reference_velocity.x - candidate_velocity.x,
+            reference_velocity.y - candidate_velocity.y,
+        };
+        float  speed = b2Length(reference_velocity);
+        double velocity_error = 0.0;
+
+        if (tick - last_bounce_tick > 1 && speed > 0.f) {
+            velocity_error = b2Length(velocity_difference) / speed;
+        }
+
+        float tolerance = PIXELS_TO_WORLD(config->ball.radius)
+                        + (comparison.bounces + 1) * step_travel;
+
+        comparison.tolerance = WORLD_TO_PIXELS(tolerance);
+
+        if (distance > tolerance
+            || velocity_error > PHYSICS_COMPARE_VELOCITY_TOLERANCE) {
+            comparison.diverged_tick = tick;
+            break;
+        }
+
+        if (WORLD_TO_PIXELS(distance) > comparison.max_distance) {
+            comparison.max_distance = WORLD_TO_PIXELS(distance);
+        }
+
+        if (velocity_error > comparison.max_velocity_error) {
+            comparison.max_velocity_error = velocity_error;
+        }
+    }
+
+    ShutdownGame(&candidate_config);
+    ShutdownGame(&reference_config);
+
+    return comparison;
+}
+
+bool PrintPhysicsComparison(const PhysicsComparison *comparison) {
+    bool consistent = comparison->diverged_tick < 0;
+
+    printf(
+        "Compared:         %s against %s\n",
+        comparison->candidate,
+        comparison->reference
+    );
+    printf(
+        "Ticks:            %ld of %ld\n",
+        comparison->ticks,
+        comparison->window_ticks
+    );
+    printf("Bounces:          %ld\n", comparison->bounces);
+    printf(
+        "Max distance:     %.3f px of %.3f px\n",
+        comparison->max_distance,
+        comparison->tolerance
+    );
+    printf(
+        "Max velocity:     %.2f %% off\n",
+        comparison->max_velocity_error * 100.0
+    );
+
+    if (comparison->diverged_tick >= 0) {
+        printf("Diverged at tick: %ld\n", comparison->diverged_tick);
+    } else {
+        printf("Diverged at tick: none\n");
+    }
+
+    printf("Consistent:       %s\n", consistent ? "yes" : "no");
+    return consistent;
+}
+
+RollbackStats RunHeadlessVersus(
+    const Configuration   *config,
+    const HeadlessOptions *options,
+    const RollbackOptions *rollback_options,
+    NetTransport          *transport
+) {
+    RollbackSession *session =
+        CreateRollbackSession(config, rollback_options, transport);
+    const Configuration *local = GetRollbackConfiguration(
+        session, rollback_options->local_player
+    );
+
+    uint64_t time_step = 1000000000ull / (uint64_t)config->tick_rate;
+    uint64_t next_tick = GetClockNanoseconds();
+
+    while (!IsRollbackOver(session)) {
+        GameInput input = options->input_source(
+            local, GetRollbackTick(session), options->input_user_data
+        );
+        AdvanceRollback(session, &input);
+
+        next_tick += time_step;
+
+        uint64_t now = GetClockNanoseconds();
+
+        // NOTE: a late tick is not made up for, the next one is due a time
+        // step from now
+        if (next_tick <= now) {
+            next_tick = now;
+            continue;
+        }
+
+        struct timespec duration = {
+            .tv_sec = (time_t)((next_tick - now) / 1000000000ull),
+            .tv_nsec = (long)((next_tick - now) % 1000000000ull),
+        };
+        thrd_sleep(&duration, NULL);
+    }
+
+    RollbackStats stats = GetRollbackStats(session);
+    DestroyRollbackSession(session);
+    return stats;
+}
@@ -0,0 +1,139 @@
+#include <breakout/level.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t ReadU32(const uint8_t *bytes) {
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8
+         | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+static float ReadF32(const uint8_t *bytes) {
+    uint32_t bits = ReadU32(bytes);
+    float    value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void WriteU32(uint8_t *bytes, uint32_t value) {
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+    bytes[2] = (uint8_t)(value >> 16);
+    bytes[3] = (uint8_t)(value >> 24);
+}
+
+static void WriteF32(uint8_t *bytes, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteU32(bytes, bits);
+}
+
+static bool IsValidLevelBrick(LevelBrick brick) {
+    return isfinite(brick.position.x) && isfinite(brick.position.y)
+        && isfinite(brick.size.x) && isfinite(brick.size.y)
+        && brick.size.x > 0.f && brick.size.y > 0.f && brick.hit_points > 0;
+}
+
+bool OpenLevel(LevelFile *level, const char *path) {
+    *level = (LevelFile){ 0 };
+
+    if (!MapFile(&level->map, path)) {
+        fprintf(stderr, "Failed to open level file \"%s\"\n", path);
+        return false;
+    }
+
+    const uint8_t *data = level->map.data;
+
+    if (level->map.size < LEVEL_HEADER_SIZE
+        || memcmp(data, LEVEL_MAGIC, 4) != 0
+        || ReadU32(data + 4) != LEVEL_VERSION) {
+        fprintf(stderr, "\"%s\" is not a version %d level\n", path, LEVEL_VERSION);
+        CloseLevel(level);
+        return false;
+    }
+
+    uint32_t brick_count = ReadU32(data + 8);
+    uint32_t record_size = ReadU32(data + 12);
+
+    if (record_size < LEVEL_BRICK_SIZE
+        || brick_count
+               > (level->map.size - LEVEL_HEADER_SIZE) / record_size) {
+        fprintf(stderr, "Level file \"%s\" is truncated\n", path);
+        CloseLevel(level);
+        return false;
+    }
+
+    level->brick_count = (int)brick_count;
+    level->record_size = (int)record_size;
+
+    // NOTE: a brick with 0 hit points would wrap to 255 on its first hit
+    for (int i = 0; i < level->brick_count; i++) {
+        if (!IsValidLevelBrick(GetLevelBrick(level, i))) {
+            fprintf(
+                stderr,
+                "Brick %d of level file \"%s\" needs a finite position, a "
+                "positive size and hit points\n",
+                i,
+                path
+            );
+            CloseLevel(level);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CloseLevel(LevelFile *level) {
+    UnmapFile(&level->map);
+    *level = (LevelFile){ 0 };
+}
+
+LevelBrick GetLevelBrick(const LevelFile *level, int index) {
+    const uint8_t *record = (const uint8_t *)level->map.data + LEVEL_HEADER_SIZE
+                          + (size_t)index * level->record_size;
+
+    return (LevelBrick){
+        .position = { ReadF32(record), ReadF32(record + 4) },
+        .size = { ReadF32(record + 8), ReadF32(record + 12) },
+        .color = { record[16], record[17], record[18], record[19] },
+        .hit_points = record[20],
+    };
+}
+
+bool WriteLevel(const char *path, const LevelBrick *bricks, int count) {
+    FILE *file = fopen(path, "wb");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open level file \"%s\" for writing\n", path);
+        return false;
+    }
+
+    uint8_t header[LEVEL_HEADER_SIZE];
+
+    memcpy(header, LEVEL_MAGIC, 4);
+    WriteU32(header + 4, LEVEL_VERSION);
+    WriteU32(header + 8, (uint32_t)count);
+    WriteU32(header + 12, LEVEL_BRICK_SIZE);
+    fwrite(header, 1, sizeof(header), file);
+
+    for (int i = 0; i < count; i++) {
+        uint8_t record[LEVEL_BRICK_SIZE] = { 0 };
+
+        WriteF32(record, bricks[i].position.x);
+        WriteF32(record + 4, bricks[i].position.y);
+        WriteF32(record + 8, bricks[i].size.x);
+        WriteF32(record + 12, bricks[i].size.y);
+        record[16] = bricks[i].color.r;
+        record[17] = bricks[i].color.g;
+        record[18] = bricks[i].color.b;
+        record[19] = bricks[i].color.a;
+        record[20] = bricks[i].hit_points;
+
+        fwrite(record, 1, sizeof(record), file);
+    }
+
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
@@ -0,0 +1,154 @@
+#include <breakout/level.h>
+#include <breakout/allocator.h>
+#include <tomlc17.h>
+#include <stdio.h>
+
+/* Accepts both 10 and 10.0 for coordinates and sizes */
+static bool GetNumber(toml_datum_t table, const char *key, float *value) {
+    toml_datum_t datum = toml_get(table, key);
+
+    if (datum.type == TOML_FP64) {
+        *value = (float)datum.u.fp64;
+        return true;
+    }
+    if (datum.type == TOML_INT64) {
+        *value = (float)datum.u.int64;
+        return true;
+    }
+    return false;
+}
+
+static bool GetColor(toml_datum_t table, const char *key, Color *color) {
+    toml_datum_t datum = toml_get(table, key);
+
+    if (datum.type != TOML_ARRAY
+        || (datum.u.arr.size != 3 && datum.u.arr.size != 4)) {
+        return false;
+    }
+
+    uint8_t components[4] = { 0, 0, 0, 255 };
+
+    for (int i = 0; i < datum.u.arr.size; i++) {
+        toml_datum_t component = datum.u.arr.elem[i];
+
+        if (component.type != TOML_INT64 || component.u.int64 < 0
+            || component.u.int64 > 255) {
+            return false;
+        }
+        components[i] = (uint8_t)component.u.int64;
+    }
+
+    *color = (Color){ components[0], components[1], components[2],
+                      components[3] };
+    return true;
+}
+
+static bool GetHitPoints(toml_datum_t table, const char *key, uint8_t *value) {
+    toml_datum_t datum = toml_get(table, key);
+
+    if (datum.type != TOML_INT64 || datum.u.int64 < 1
+        || datum.u.int64 > LEVEL_MAX_HIT_POINTS) {
+        return false;
+    }
+
+    *value = (uint8_t)datum.u.int64;
+    return true;
+}
+
+/* Reads whatever keys the table has over brick, true if all were valid */
+static bool ReadBrick(toml_datum_t table, LevelBrick *brick) {
+    bool ok = true;
+
+    if (toml_get(table, "x").type != TOML_UNKNOWN) {
+        ok &= GetNumber(table, "x", &brick->position.x);
+    }
+    if (toml_get(table, "y").type != TOML_UNKNOWN) {
+        ok &= GetNumber(table, "y", &brick->position.y);
+    }
+    if (toml_get(table, "width").type != TOML_UNKNOWN) {
+        ok &= GetNumber(table, "width", &brick->size.x);
+    }
+    if (toml_get(table, "height").type != TOML_UNKNOWN) {
+        ok &= GetNumber(table, "height", &brick->size.y);
+    }
+    if (toml_get(table, "color").type != TOML_UNKNOWN) {
+        ok &= GetColor(table, "color", &brick->color);
+    }
+    if (toml_get(table, "hit_points").type != TOML_UNKNOWN) {
+        ok &= GetHitPoints(table, "hit_points", &brick->hit_points);
+    }
+
+    return ok;
+}
+
+bool CompileLevel(const char *source_path, const char *level_path) {
+    toml_result_t parse_result = toml_parse_file_ex(source_path);
+
+    if (!parse_result.ok) {
+        fprintf(
+            stderr,
+            "Failed to read level \"%s\" with error:\n%s\n",
+            source_path,
+            parse_result.errmsg
+        );
+        toml_free(parse_result);
+        return false;
+    }
+
+    LevelBrick defaults = {
+        .size = { 60.f, 20.f },
+        .color = RAYWHITE,
+        .hit_points = 1,
+    };
+
+    toml_datum_t defaults_table = toml_get(parse_result.toptab, "defaults");
+
+    if (defaults_table.type == TOML_TABLE
+        && !ReadBrick(defaults_table, &defaults)) {
+        fprintf(stderr, "Invalid value in [defaults] of \"%s\"\n", source_path);
+        toml_free(parse_result);
+        return false;
+    }
+
+    toml_datum_t bricks_array = toml_get(parse_result.toptab, "bricks");
+
+    if (bricks_array.type != TOML_ARRAY) {
+        fprintf(stderr, "\"%s\" has no [[bricks]]\n", source_path);
+        toml_free(parse_result);
+        return false;
+    }
+
+    int         count = bricks_array.u.arr.size;
+    LevelBrick *bricks = MemoryAlloc(
+        MEMORY_GAME, sizeof(LevelBrick) * (count > 0 ? count : 1)
+    );
+    bool        ok = true;
+
+    for (int i = 0; i < count && ok; i++) {
+        toml_datum_t table = bricks_array.u.arr.elem[i];
+
+        bricks[i] = defaults;
+
+        if (table.type != TOML_TABLE || !ReadBrick(table, &bricks[i])
+            || toml_get(table, "x").type == TOML_UNKNOWN
+            || toml_get(table, "y").type == TOML_UNKNOWN
+            || !(bricks[i].size.x > 0.f) || !(bricks[i].size.y > 0.f)) {
+            fprintf(
+                stderr,
+                "Brick %d of \"%s\" needs x, y and a positive size\n",
+                i,
+                source_path
+            );
+            ok = false;
+        }
+    }
+
+    toml_free(parse_result);
+
+    if (ok) {
+        ok = WriteLevel(level_path, bricks, count);
+    }
+
+    MemoryFree(bricks);
+    return ok;
+}
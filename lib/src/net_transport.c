@@ -0,0 +1,260 @@
+#include <breakout/net_transport.h>
+#include <breakout/allocator.h>
+#include <breakout/clock.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET NetSocket;
+#define NET_INVALID_SOCKET INVALID_SOCKET
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int NetSocket;
+#define NET_INVALID_SOCKET (-1)
+#endif
+
+typedef struct DelayedPacket {
+    uint64_t due;
+    int      size;
+    uint8_t  data[NET_MAX_PACKET_SIZE];
+} DelayedPacket;
+
+struct NetTransport {
+    NetSocket          socket;
+    struct sockaddr_in peer;
+    NetConditions      conditions;
+    NetStats           stats;
+    uint32_t           random_state;
+    // NOTE: the latency is the same for every packet, so they fall due in
+    // the order they were sent and a FIFO ring is enough
+    DelayedPacket      delayed[NET_MAX_DELAYED_PACKETS];
+    int                delayed_head;
+    int                delayed_count;
+};
+
+static void CloseSocket(NetSocket socket) {
+#ifdef _WIN32
+    closesocket(socket);
+#else
+    close(socket);
+#endif
+}
+
+static bool SetNonBlocking(NetSocket socket) {
+#ifdef _WIN32
+    u_long enabled = 1;
+    return ioctlsocket(socket, FIONBIO, &enabled) == 0;
+#else
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+static bool ResolvePeer(
+    struct sockaddr_in *address, const char *host, int port
+) {
+    struct addrinfo  hints = { .ai_family = AF_INET, .ai_socktype = SOCK_DGRAM };
+    struct addrinfo *result = NULL;
+
+    if (getaddrinfo(host, NULL, &hints, &result) != 0 || !result) {
+        return false;
+    }
+
+    memcpy(address, result->ai_addr, sizeof(*address));
+    address->sin_port = htons((uint16_t)port);
+    freeaddrinfo(result);
+    return true;
+}
+
+static uint32_t NextRandom(uint32_t *state) {
+    // NOTE: xorshift32, the loss pattern is the same on every run
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+NetTransport *OpenNetTransport(
+    int port, const char *peer_host, int peer_port, NetConditions conditions
+) {
+#ifdef _WIN32
+    WSADATA wsa_data;
+
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+        fprintf(stderr, "Failed to start Winsock\n");
+        return NULL;
+    }
+#endif
+
+    NetTransport *transport =
+        MemoryCalloc(MEMORY_GAME, 1, sizeof(NetTransport));
+
+    transport->conditions = conditions;
+    transport->random_state = 0x9e3779b9u ^ (uint32_t)port;
+
+    if (!ResolvePeer(&transport->peer, peer_host, peer_port)) {
+        fprintf(stderr, "Failed to resolve peer \"%s\"\n", peer_host);
+        MemoryFree(transport);
+        return NULL;
+    }
+
+    transport->socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+    struct sockaddr_in local = {
+        .sin_family = AF_INET,
+        .sin_port = htons((uint16_t)port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+
+    if (transport->socket == NET_INVALID_SOCKET
+        || bind(
+               transport->socket, (struct sockaddr *)&local, sizeof(local)
+           ) != 0
+        || !SetNonBlocking(transport->socket)) {
+        fprintf(stderr, "Failed to bind UDP port %d\n", port);
+
+        if (transport->socket != NET_INVALID_SOCKET) {
+            CloseSocket(transport->socket);
+        }
+        MemoryFree(transport);
+        return NULL;
+    }
+
+    return transport;
+}
+
+void CloseNetTransport(NetTransport *transport) {
+    if (!transport) {
+        return;
+    }
+
+    CloseSocket(transport->socket);
+    MemoryFree(transport);
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+static void SendNow(NetTransport *transport, const void *data, int size) {
+    sendto(
+        transport->socket,
+        data,
+        size,
+        0,
+        (const struct sockaddr *)&transport->peer,
+        sizeof(transport->peer)
+    );
+}
+
+static void FlushDelayedPackets(NetTransport *transport) {
+    uint64_t now = GetClockNanoseconds();
+
+    while (transport->delayed_count > 0) {
+        DelayedPacket *packet = &transport->delayed[transport->delayed_head];
+
+        if (packet->due > now) {
+            break;
+        }
+
+        SendNow(transport, packet->data, packet->size);
+
+        transport->delayed_head =
+            (transport->delayed_head + 1) % NET_MAX_DELAYED_PACKETS;
+        transport->delayed_count--;
+    }
+}
+
+void SendNetPacket(NetTransport *transport, const void *data, int size) {
+    if (size > NET_MAX_PACKET_SIZE) {
+        return;
+    }
+
+    transport->stats.sent++;
+
+    // NOTE: 24 bits of the random number are enough for a share
+    if ((NextRandom(&transport->random_state) & 0xffffff)
+        < transport->conditions.loss * 0x1000000) {
+        transport->stats.dropped++;
+        FlushDelayedPackets(transport);
+        return;
+    }
+
+    if (transport->conditions.latency_milliseconds <= 0) {
+        SendNow(transport, data, size);
+        return;
+    }
+
+    if (transport->delayed_count == NET_MAX_DELAYED_PACKETS) {
+        transport->stats.dropped++;
+    } else {
+        int index = (transport->delayed_head + transport->delayed_count)
+                  % NET_MAX_DELAYED_PACKETS;
+        DelayedPacket *packet = &transport->delayed[index];
+
+        packet->due = GetClockNanoseconds()
+                    + (uint64_t)transport->conditions.latency_milliseconds
+                          * 1000000ull;
+        packet->size = size;
+        memcpy(packet->data, data, size);
+        transport->delayed_count++;
+    }
+
+    FlushDelayedPackets(transport);
+}
+
+int ReceiveNetPacket(NetTransport *transport, void *buffer, int capacity) {
+    FlushDelayedPackets(transport);
+
+    for (;;) {
+        struct sockaddr_in from;
+        socklen_t          from_size = sizeof(from);
+
+        int size = (int)recvfrom(
+            transport->socket,
+            buffer,
+            capacity,
+            0,
+            (struct sockaddr *)&from,
+            &from_size
+        );
+
+        if (size < 0) {
+#ifdef _WIN32
+            // NOTE: the port unreachable reply to an earlier send, the peer
+            // has not bound its socket yet
+            if (WSAGetLastError() == WSAECONNRESET) {
+                continue;
+            }
+#else
+            if (errno == EINTR) {
+                continue;
+            }
+#endif
+            return 0;
+        }
+
+        if (from.sin_addr.s_addr != transport->peer.sin_addr.s_addr
+            || from.sin_port != transport->peer.sin_port) {
+            continue;
+        }
+
+        transport->stats.received++;
+        return size;
+    }
+}
+
+NetStats GetNetStats(const NetTransport *transport) {
+    return transport->stats;
+}
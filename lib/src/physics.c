@@ -0,0 +1,21 @@
+#include <breakout/physics.h>
+#include <string.h>
+
+static const PhysicsBackend *const BACKENDS[PHYSICS_KIND_COUNT] = {
+    [PHYSICS_BOX2D] = &BOX2D_PHYSICS,
+    [PHYSICS_ANALYTIC] = &ANALYTIC_PHYSICS,
+};
+
+const PhysicsBackend *GetPhysicsBackend(PhysicsKind kind) {
+    return kind >= 0 && kind < PHYSICS_KIND_COUNT ? BACKENDS[kind] : NULL;
+}
+
+const PhysicsBackend *FindPhysicsBackend(const char *name) {
+    for (int kind = 0; kind < PHYSICS_KIND_COUNT; kind++) {
+        if (strcmp(BACKENDS[kind]->name, name) == 0) {
+            return BACKENDS[kind];
+        }
+    }
+
+    return NULL;
+}
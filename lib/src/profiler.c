@@ -0,0 +1,149 @@
+#include <breakout/profiler.h>
+#include <breakout/allocator.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NANOSECONDS_TO_MILLISECONDS(ns) ((double)(ns) / 1e6)
+
+static const char *phase_names[PROFILE_PHASE_COUNT] = {
+    [PROFILE_PHASE_INPUT] = "input",
+    [PROFILE_PHASE_STEP] = "step",
+    [PROFILE_PHASE_STEP_COLLIDE] = "step_collide",
+    [PROFILE_PHASE_STEP_SOLVE] = "step_solve",
+    [PROFILE_PHASE_COLLISIONS] = "collisions",
+    [PROFILE_PHASE_CLAMP] = "clamp",
+    [PROFILE_PHASE_BALLS] = "balls",
+    [PROFILE_PHASE_DRAW] = "draw",
+    [PROFILE_PHASE_PRESENT] = "present",
+    [PROFILE_PHASE_FRAME] = "frame",
+};
+
+void CreateProfiler(Profiler *profiler, int capacity) {
+    *profiler = (Profiler){
+        .samples = MemoryCalloc(
+            MEMORY_GAME,
+            (size_t)capacity * PROFILE_PHASE_COUNT,
+            sizeof(uint64_t)
+        ),
+        .scratch = MemoryAlloc(MEMORY_GAME, sizeof(uint64_t) * capacity),
+        .capacity = capacity,
+    };
+}
+
+void FreeProfiler(Profiler *profiler) {
+    MemoryFree(profiler->samples);
+    MemoryFree(profiler->scratch);
+    *profiler = (Profiler){ 0 };
+}
+
+const char *GetProfilePhaseName(ProfilePhase phase) {
+    return phase_names[phase];
+}
+
+void AddProfileTime(
+    Profiler *profiler, ProfilePhase phase, uint64_t nanoseconds
+) {
+    if (profiler) {
+        profiler->current[phase] += nanoseconds;
+    }
+}
+
+void BeginProfilerFrame(Profiler *profiler) {
+    if (!profiler) {
+        return;
+    }
+
+    memset(profiler->current, 0, sizeof(profiler->current));
+    profiler->frame_start = GetClockNanoseconds();
+}
+
+void EndProfilerFrame(Profiler *profiler) {
+    if (!profiler) {
+        return;
+    }
+
+    profiler->current[PROFILE_PHASE_FRAME] =
+        GetClockNanoseconds() - profiler->frame_start;
+
+    memcpy(
+        profiler->samples + (size_t)profiler->head * PROFILE_PHASE_COUNT,
+        profiler->current,
+        sizeof(profiler->current)
+    );
+
+    profiler->head = (profiler->head + 1) % profiler->capacity;
+    profiler->frame++;
+
+    if (profiler->count < profiler->capacity) {
+        profiler->count++;
+    }
+}
+
+static int CompareSamples(const void *a, const void *b) {
+    uint64_t left = *(const uint64_t *)a;
+    uint64_t right = *(const uint64_t *)b;
+    return (left > right) - (left < right);
+}
+
+ProfileStats GetProfileStats(Profiler *profiler, ProfilePhase phase) {
+    if (profiler->count == 0) {
+        return (ProfileStats){ 0 };
+    }
+
+    uint64_t total = 0;
+
+    // NOTE: ring order does not matter for the statistics
+    for (int i = 0; i < profiler->count; i++) {
+        profiler->scratch[i] =
+            profiler->samples[(size_t)i * PROFILE_PHASE_COUNT + phase];
+        total += profiler->scratch[i];
+    }
+
+    qsort(profiler->scratch, profiler->count, sizeof(uint64_t), CompareSamples);
+
+    int p99_index = (int)((long long)(profiler->count - 1) * 99 / 100);
+
+    return (ProfileStats){
+        .min_milliseconds = NANOSECONDS_TO_MILLISECONDS(profiler->scratch[0]),
+        .average_milliseconds =
+            NANOSECONDS_TO_MILLISECONDS(total) / profiler->count,
+        .p99_milliseconds =
+            NANOSECONDS_TO_MILLISECONDS(profiler->scratch[p99_index]),
+    };
+}
+
+bool WriteProfilerCsv(const Profiler *profiler, const char *path) {
+    FILE *file = fopen(path, "w");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open profile file \"%s\" for writing\n", path);
+        return false;
+    }
+
+    fprintf(file, "frame");
+    for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+        fprintf(file, ",%s_ms", phase_names[phase]);
+    }
+    fprintf(file, "\n");
+
+    int  oldest = (profiler->head - profiler->count + profiler->capacity)
+               % profiler->capacity;
+    long first_frame = profiler->frame - profiler->count;
+
+    for (int i = 0; i < profiler->count; i++) {
+        const uint64_t *sample =
+            profiler->samples
+            + (size_t)((oldest + i) % profiler->capacity) * PROFILE_PHASE_COUNT;
+
+        fprintf(file, "%ld", first_frame + i);
+        for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+            fprintf(file, ",%.4f", NANOSECONDS_TO_MILLISECONDS(sample[phase]));
+        }
+        fprintf(file, "\n");
+    }
+
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
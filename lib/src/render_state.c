@@ -0,0 +1,166 @@
+#include <breakout/render_state.h>
+#include <breakout/clock.h>
+#include <string.h>
+
+#define RENDER_STATE_FRESH 0x4
+#define RENDER_STATE_INDEX 0x3
+
+static Vector2 ToPixels(b2Vec2 position) {
+    return (Vector2){
+        WORLD_TO_PIXELS(position.x),
+        WORLD_TO_PIXELS(position.y),
+    };
+}
+
+void CreateRenderStateBuffer(RenderStateBuffer *buffer) {
+    memset(buffer->slots, 0, sizeof(buffer->slots));
+    buffer->write = 0;
+    buffer->read = 2;
+    atomic_init(&buffer->ready, 1);
+}
+
+void FreeRenderStateBuffer(RenderStateBuffer *buffer) {
+    for (int i = 0; i < RENDER_STATE_SLOTS; i++) {
+        RenderState *state = &buffer->slots[i];
+
+        MemoryFree(state->live);
+        MemoryFree(state->brick_positions);
+        MemoryFree(state->brick_sizes);
+        MemoryFree(state->brick_colors);
+        MemoryFree(state->swarm_x);
+        MemoryFree(state->swarm_y);
+        MemoryFree(state->swarm_previous_x);
+        MemoryFree(state->swarm_previous_y);
+        *state = (RenderState){ 0 };
+    }
+}
+
+RenderState *GetRenderStateWriteSlot(RenderStateBuffer *buffer) {
+    return &buffer->slots[buffer->write];
+}
+
+static void CaptureBricks(
+    RenderState *state, const Configuration *config, long layout_version
+) {
+    const BrickStore *bricks = &config->bricks;
+
+    if (bricks->count > state->brick_capacity) {
+        MemoryFree(state->live);
+        MemoryFree(state->brick_positions);
+        MemoryFree(state->brick_sizes);
+        MemoryFree(state->brick_colors);
+
+        int word_count =
+            (bricks->count + BRICK_STORE_WORD_BITS - 1) / BRICK_STORE_WORD_BITS;
+
+        state->live = MemoryAlloc(MEMORY_GAME, sizeof(uint64_t) * word_count);
+        state->brick_positions =
+            MemoryAlloc(MEMORY_GAME, sizeof(Vector2) * bricks->count);
+        state->brick_sizes =
+            MemoryAlloc(MEMORY_GAME, sizeof(Vector2) * bricks->count);
+        state->brick_colors =
+            MemoryAlloc(MEMORY_GAME, sizeof(Color) * bricks->count);
+        state->brick_capacity = bricks->count;
+        // NOTE: the new arrays hold no layout yet
+        state->layout_version = -1;
+    }
+
+    state->brick_count = bricks->count;
+    state->word_count = bricks->word_count;
+    memcpy(state->live, bricks->live, sizeof(uint64_t) * bricks->word_count);
+
+    if (state->layout_version == layout_version && !state->scrolling) {
+        return;
+    }
+
+    memcpy(
+        state->brick_positions,
+        bricks->positions,
+        sizeof(Vector2) * bricks->count
+    );
+    memcpy(state->brick_sizes, bricks->sizes, sizeof(Vector2) * bricks->count);
+    memcpy(state->brick_colors, bricks->colors, sizeof(Color) * bricks->count);
+    state->layout_version = layout_version;
+}
+
+static void CaptureSwarm(RenderState *state, const BallSwarm *swarm) {
+    size_t size = sizeof(float) * swarm->count;
+
+    if (swarm->count > state->swarm_capacity) {
+        MemoryFree(state->swarm_x);
+        MemoryFree(state->swarm_y);
+        MemoryFree(state->swarm_previous_x);
+        MemoryFree(state->swarm_previous_y);
+
+        state->swarm_x = MemoryAlloc(MEMORY_GAME, size);
+        state->swarm_y = MemoryAlloc(MEMORY_GAME, size);
+        state->swarm_previous_x = MemoryAlloc(MEMORY_GAME, size);
+        state->swarm_previous_y = MemoryAlloc(MEMORY_GAME, size);
+        state->swarm_capacity = swarm->count;
+    }
+
+    state->swarm_count = swarm->count;
+
+    if (swarm->count > 0) {
+        memcpy(state->swarm_x, swarm->position_x, size);
+        memcpy(state->swarm_y, swarm->position_y, size);
+        memcpy(state->swarm_previous_x, swarm->previous_x, size);
+        memcpy(state->swarm_previous_y, swarm->previous_y, size);
+    }
+}
+
+void CaptureRenderState(
+    RenderState         *state,
+    const Configuration *config,
+    long                 tick,
+    long                 layout_version
+) {
+    state->tick = tick;
+    state->captured_at = GetClockNanoseconds();
+    state->time_step = 1.0 / config->tick_rate;
+    state->background_color = config->background_color;
+
+    state->player_previous = ToPixels(config->player.previous_position);
+    state->player_position = ToPixels(GetPlayerPosition(config));
+    state->player_size =
+        (Vector2){ config->player.width, config->player.height };
+    state->player_color = config->player.color;
+
+    state->ball_previous = ToPixels(config->ball.previous_position);
+    state->ball_position = ToPixels(GetBallPosition(config));
+    state->ball_velocity = GetBallVelocity(config);
+    state->ball_radius = config->ball.radius;
+    state->ball_color = config->ball.color;
+
+    state->scrolling = config->endless.row_count > 0;
+    state->score = state->scrolling
+                     ? config->endless.destroyed_count
+                     : config->bricks.count - CountLiveBricks(&config->bricks);
+
+    CaptureBricks(state, config, layout_version);
+    CaptureSwarm(state, &config->swarm);
+}
+
+void PublishRenderState(RenderStateBuffer *buffer) {
+    int previous = atomic_exchange_explicit(
+        &buffer->ready,
+        buffer->write | RENDER_STATE_FRESH,
+        memory_order_acq_rel
+    );
+
+    buffer->write = previous & RENDER_STATE_INDEX;
+}
+
+const RenderState *AcquireRenderState(RenderStateBuffer *buffer) {
+    // NOTE: without a fresh state the one read last is drawn again
+    if (atomic_load_explicit(&buffer->ready, memory_order_relaxed)
+        & RENDER_STATE_FRESH) {
+        int previous = atomic_exchange_explicit(
+            &buffer->ready, buffer->read, memory_order_acq_rel
+        );
+
+        buffer->read = previous & RENDER_STATE_INDEX;
+    }
+
+    return &buffer->slots[buffer->read];
+}
@@ -0,0 +1,452 @@
+#include <breakout/replay.h>
+#include <breakout/clock.h>
+#include <breakout/game.h>
+#include <breakout/snapshot.h>
+#include <stdio.h>
+#include <string.h>
+
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME        16777619u
+
+uint8_t EncodeReplayInput(const GameInput *input) {
+    return (input->move_left ? REPLAY_INPUT_LEFT : 0)
+         | (input->move_right ? REPLAY_INPUT_RIGHT : 0)
+         | (input->reset_ball ? REPLAY_INPUT_RESET : 0);
+}
+
+GameInput DecodeReplayInput(uint8_t input) {
+    return (GameInput){
+        .move_left = input & REPLAY_INPUT_LEFT,
+        .move_right = input & REPLAY_INPUT_RIGHT,
+        .reset_ball = input & REPLAY_INPUT_RESET,
+    };
+}
+
+static uint32_t HashBytes(uint32_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+uint32_t HashGameState(const Configuration *config) {
+    b2Vec2 ball = GetBallPosition(config);
+    b2Vec2 ball_velocity = GetBallVelocity(config);
+    b2Vec2 player = GetPlayerPosition(config);
+
+    uint32_t hash = FNV_OFFSET_BASIS;
+    hash = HashBytes(hash, &ball, sizeof(ball));
+    hash = HashBytes(hash, &ball_velocity, sizeof(ball_velocity));
+    hash = HashBytes(hash, &player, sizeof(player));
+    hash = HashBytes(
+        hash,
+        config->bricks.live,
+        sizeof(uint64_t) * config->bricks.word_count
+    );
+
+    hash = HashBytes(
+        hash,
+        config->bricks.hit_points,
+        sizeof(uint8_t) * config->bricks.count
+    );
+
+    return hash;
+}
+
+uint32_t HashSnapshot(const void *buffer) {
+    const GameSnapshot *snapshot = buffer;
+    int                 word_count =
+        ((int)snapshot->brick_count + BRICK_STORE_WORD_BITS - 1)
+        / BRICK_STORE_WORD_BITS;
+
+    uint32_t hash = FNV_OFFSET_BASIS;
+    hash = HashBytes(
+        hash, &snapshot->ball_position, sizeof(snapshot->ball_position)
+    );
+    hash = HashBytes(
+        hash, &snapshot->ball_velocity, sizeof(snapshot->ball_velocity)
+    );
+    hash = HashBytes(
+        hash, &snapshot->player_position, sizeof(snapshot->player_position)
+    );
+    // NOTE: SaveSnapshot puts the hit points right after the live words
+    hash = HashBytes(
+        hash,
+        snapshot + 1,
+        sizeof(uint64_t) * word_count
+            + sizeof(uint8_t) * snapshot->brick_count
+    );
+
+    return hash;
+}
+
+void BeginRecording(
+    Replay *replay, const Configuration *config, long hash_interval
+) {
+    *replay = (Replay){
+        .header = {
+            .bricks_in_row = config->bricks_in_row,
+            .tick_rate = config->tick_rate,
+            .hash_interval = hash_interval,
+            .player_width = config->player.width,
+            .player_height = config->player.height,
+            .player_movement_speed = config->player.movement_speed,
+            .ball_radius = config->ball.radius,
+            .ball_max_speed = config->ball.max_speed,
+            .ball_min_speed_multiplier = config->ball.min_speed_multiplier,
+            .ball_initial_velocity = config->ball.initial_velocity,
+            .physics = config->physics->kind,
+        },
+    };
+}
+
+void RecordReplayTick(
+    Replay *replay, const Configuration *config, const GameInput *input
+) {
+    uint8_t encoded = EncodeReplayInput(input);
+
+    if (replay->run_count > 0
+        && replay->runs[replay->run_count - 1].input == encoded) {
+        replay->runs[replay->run_count - 1].length++;
+    } else {
+        if (replay->run_count == replay->run_capacity) {
+            replay->run_capacity =
+                replay->run_capacity ? replay->run_capacity * 2 : 256;
+            replay->runs = MemoryRealloc(
+                MEMORY_GAME,
+                replay->runs,
+                sizeof(ReplayRun) * replay->run_capacity
+            );
+        }
+
+        replay->runs[replay->run_count++] = (ReplayRun){ encoded, 1 };
+    }
+
+    replay->tick_count++;
+
+    long interval = replay->header.hash_interval;
+
+    if (interval > 0 && replay->tick_count % interval == 0) {
+        if (replay->hash_count == replay->hash_capacity) {
+            replay->hash_capacity =
+                replay->hash_capacity ? replay->hash_capacity * 2 : 64;
+            replay->hashes = MemoryRealloc(
+                MEMORY_GAME,
+                replay->hashes,
+                sizeof(uint32_t) * replay->hash_capacity
+            );
+        }
+
+        replay->hashes[replay->hash_count++] = HashGameState(config);
+    }
+}
+
+void FreeReplay(Replay *replay) {
+    MemoryFree(replay->runs);
+    MemoryFree(replay->hashes);
+    *replay = (Replay){ 0 };
+}
+
+static void WriteU32(FILE *file, uint32_t value) {
+    uint8_t bytes[4] = { value, value >> 8, value >> 16, value >> 24 };
+    fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+static void WriteU64(FILE *file, uint64_t value) {
+    WriteU32(file, (uint32_t)value);
+    WriteU32(file, (uint32_t)(value >> 32));
+}
+
+static void WriteF64(FILE *file, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteU64(file, bits);
+}
+
+static void WriteF32(FILE *file, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteU32(file, bits);
+}
+
+static void WriteVarint(FILE *file, uint32_t value) {
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7f) | 0x80, file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
+
+static bool ReadU32(FILE *file, uint32_t *value) {
+    uint8_t bytes[4];
+
+    if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) {
+        return false;
+    }
+
+    *value = (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8
+           | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+    return true;
+}
+
+static bool ReadU64(FILE *file, uint64_t *value) {
+    uint32_t low, high;
+
+    if (!ReadU32(file, &low) || !ReadU32(file, &high)) {
+        return false;
+    }
+
+    *value = (uint64_t)high << 32 | low;
+    return true;
+}
+
+static bool ReadF64(FILE *file, double *value) {
+    uint64_t bits;
+
+    if (!ReadU64(file, &bits)) {
+        return false;
+    }
+
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+}
+
+static bool ReadF32(FILE *file, float *value) {
+    uint32_t bits;
+
+    if (!ReadU32(file, &bits)) {
+        return false;
+    }
+
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+}
+
+static bool ReadVarint(FILE *file, uint32_t *value) {
+    *value = 0;
+
+    for (int shift = 0; shift < 35; shift += 7) {
+        int byte = fgetc(file);
+
+        if (byte == EOF) {
+            return false;
+        }
+
+        *value |= (uint32_t)(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SaveReplay(const Replay *replay, const char *path) {
+    FILE *file = fopen(path, "wb");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open replay file \"%s\" for writing\n", path);
+        return false;
+    }
+
+    const ReplayHeader *header = &replay->header;
+
+    fwrite(REPLAY_MAGIC, 1, 4, file);
+    WriteU32(file, REPLAY_VERSION);
+    WriteU32(file, (uint32_t)header->bricks_in_row);
+    WriteU32(file, (uint32_t)header->tick_rate);
+    WriteU32(file, (uint32_t)header->hash_interval);
+    WriteF64(file, header->player_width);
+    WriteF64(file, header->player_height);
+    WriteF64(file, header->player_movement_speed);
+    WriteF64(file, header->ball_radius);
+    WriteF64(file, header->ball_max_speed);
+    WriteF64(file, header->ball_min_speed_multiplier);
+    WriteF32(file, header->ball_initial_velocity.x);
+    WriteF32(file, header->ball_initial_velocity.y);
+    WriteU32(file, (uint32_t)header->physics);
+
+    WriteU64(file, (uint64_t)replay->tick_count);
+    WriteU32(file, (uint32_t)replay->run_count);
+
+    for (int i = 0; i < replay->run_count; i++) {
+        fputc(replay->runs[i].input, file);
+        WriteVarint(file, replay->runs[i].length);
+    }
+
+    WriteU32(file, (uint32_t)replay->hash_count);
+
+    for (int i = 0; i < replay->hash_count; i++) {
+        WriteU32(file, replay->hashes[i]);
+    }
+
+    bool ok = !ferror(file);
+    fclose(file);
+
+    if (!ok) {
+        fprintf(stderr, "Failed to write replay file \"%s\"\n", path);
+    }
+
+    return ok;
+}
+
+bool LoadReplay(Replay *replay, const char *path) {
+    *replay = (Replay){ 0 };
+
+    FILE *file = fopen(path, "rb");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open replay file \"%s\"\n", path);
+        return false;
+    }
+
+    char     magic[4];
+    uint32_t version = 0;
+    uint32_t bricks_in_row, tick_rate, hash_interval, run_count, hash_count;
+    uint32_t physics;
+    uint64_t tick_count;
+
+    ReplayHeader *header = &replay->header;
+
+    bool ok = fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+           && memcmp(magic, REPLAY_MAGIC, sizeof(magic)) == 0
+           && ReadU32(file, &version)
+           && version == REPLAY_VERSION
+           && ReadU32(file, &bricks_in_row) && ReadU32(file, &tick_rate)
+           && ReadU32(file, &hash_interval)
+           && ReadF64(file, &header->player_width)
+           && ReadF64(file, &header->player_height)
+           && ReadF64(file, &header->player_movement_speed)
+           && ReadF64(file, &header->ball_radius)
+           && ReadF64(file, &header->ball_max_speed)
+           && ReadF64(file, &header->ball_min_speed_multiplier)
+           && ReadF32(file, &header->ball_initial_velocity.x)
+           && ReadF32(file, &header->ball_initial_velocity.y)
+           && ReadU32(file, &physics)
+           && ReadU64(file, &tick_count) && ReadU32(file, &run_count);
+
+    if (ok) {
+        header->bricks_in_row = bricks_in_row;
+        header->tick_rate = tick_rate;
+        header->hash_interval = hash_interval;
+        header->physics = (PhysicsKind)physics;
+        replay->tick_count = (long)tick_count;
+        replay->run_count = replay->run_capacity = (int)run_count;
+        replay->runs =
+            MemoryCalloc(MEMORY_GAME, run_count, sizeof(ReplayRun));
+        ok = run_count == 0 || replay->runs;
+
+        for (uint32_t i = 0; ok && i < run_count; i++) {
+            int input = fgetc(file);
+            ok = input != EOF && ReadVarint(file, &replay->runs[i].length);
+            replay->runs[i].input = (uint8_t)input;
+        }
+    }
+
+    if (ok && ReadU32(file, &hash_count)) {
+        replay->hash_count = replay->hash_capacity = (int)hash_count;
+        replay->hashes =
+            MemoryCalloc(MEMORY_GAME, hash_count, sizeof(uint32_t));
+        ok = hash_count == 0 || replay->hashes;
+
+        for (uint32_t i = 0; ok && i < hash_count; i++) {
+            ok = ReadU32(file, &replay->hashes[i]);
+        }
+    } else {
+        ok = false;
+    }
+
+    fclose(file);
+
+    if (!ok || header->tick_rate <= 0 || header->bricks_in_row <= 0
+        || physics >= PHYSICS_KIND_COUNT) {
+        fprintf(stderr, "Replay file \"%s\" is corrupted\n", path);
+        FreeReplay(replay);
+        return false;
+    }
+
+    return true;
+}
+
+void ApplyReplayConfiguration(const Replay *replay, Configuration *config) {
+    const ReplayHeader *header = &replay->header;
+
+    config->bricks_in_row = header->bricks_in_row;
+    config->tick_rate = header->tick_rate;
+    config->player.width = header->player_width;
+    config->player.height = header->player_height;
+    config->player.movement_speed = header->player_movement_speed;
+    config->ball.radius = header->ball_radius;
+    config->ball.max_speed = header->ball_max_speed;
+    config->ball.min_speed_multiplier = header->ball_min_speed_multiplier;
+    config->ball.initial_velocity = header->ball_initial_velocity;
+    config->physics = GetPhysicsBackend(header->physics);
+    // NOTE: recordings do not describe swarm balls or scrolling, they play
+    // with one ball on the fixed field
+    config->ball_count = 0;
+    config->scroll_speed = 0.0;
+}
+
+ReplayReport RunReplay(const Replay *replay, Configuration *config) {
+    ReplayReport report = { .diverged_tick = -1 };
+    long         interval = replay->header.hash_interval;
+
+    ApplyReplayConfiguration(replay, config);
+    config->recorder = NULL;
+
+    InitGame(config);
+
+    double start = GetClockSeconds();
+
+    for (int i = 0; i < replay->run_count; i++) {
+        GameInput input = DecodeReplayInput(replay->runs[i].input);
+
+        for (uint32_t j = 0; j < replay->runs[i].length; j++) {
+            TickGame(config, &input);
+            report.ticks++;
+
+            if (interval <= 0 || report.ticks % interval != 0) {
+                continue;
+            }
+
+            long hash_index = report.ticks / interval - 1;
+
+            if (hash_index >= replay->hash_count) {
+                continue;
+            }
+
+            report.checked_hashes++;
+
+            if (report.diverged_tick < 0
+                && HashGameState(config) != replay->hashes[hash_index]) {
+                report.diverged_tick = report.ticks;
+            }
+        }
+    }
+
+    report.seconds = GetClockSeconds() - start;
+    report.ticks_per_second =
+        report.seconds > 0.0 ? report.ticks / report.seconds : 0.0;
+
+    ShutdownGame(config);
+
+    return report;
+}
+
+void PrintReplayReport(const ReplayReport *report) {
+    printf("Ticks:            %ld\n", report->ticks);
+    printf("Checked hashes:   %ld\n", report->checked_hashes);
+
+    if (report->diverged_tick >= 0) {
+        printf("Diverged at tick: %ld\n", report->diverged_tick);
+    } else {
+        printf("Diverged at tick: none\n");
+    }
+
+    printf("Elapsed:          %.3f s\n", report->seconds);
+    printf("Ticks/sec:        %.0f\n", report->ticks_per_second);
+}
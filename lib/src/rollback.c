@@ -0,0 +1,639 @@
+#include <breakout/rollback.h>
+#include <breakout/clock.h>
+#include <breakout/replay.h>
+#include <breakout/snapshot.h>
+#include <stdio.h>
+#include <string.h>
+
+#define ROLLBACK_PACKET_MAGIC "BKVS"
+
+// NOTE: magic, sending player, inputs received, first input tick, input
+// count, hash tick, hash, current tick and frame advantage, followed by one
+// byte per input
+#define ROLLBACK_PACKET_HEADER_SIZE 27
+
+// NOTE: inputs not acknowledged yet are sent again with every packet, a lost
+// packet costs nothing once a later one gets through
+#define ROLLBACK_MAX_PACKET_INPUTS 64
+
+// NOTE: ticks of input kept, the peers never get half of this apart
+#define ROLLBACK_INPUT_RING 256
+
+#define ROLLBACK_HASH_HISTORY 8
+
+// NOTE: sent once the result is known to both, so the peer sees the last
+// acknowledgement even over a lossy link
+#define ROLLBACK_LINGER_PACKETS 30
+
+// NOTE: the peer that runs ahead holds back one call at most this often,
+// until the two are level
+#define ROLLBACK_SYNC_INTERVAL 10
+
+typedef struct TickHash {
+    long     tick;
+    uint32_t hash;
+} TickHash;
+
+typedef struct RollbackPlayer {
+    Configuration config;
+    // NOTE: indexed by tick, the state before that tick ran
+    SnapshotRing  snapshots;
+    // NOTE: indexed by tick % ROLLBACK_INPUT_RING, as played or received
+    GameInput     inputs[ROLLBACK_INPUT_RING];
+    int           bricks_total;
+} RollbackPlayer;
+
+struct RollbackSession {
+    RollbackPlayer  players[ROLLBACK_PLAYER_COUNT];
+    RollbackOptions options;
+    NetTransport   *transport;
+    int             remote_player;
+    long            tick;
+    // NOTE: inputs are known for every tick before these, the local ones run
+    // input_delay ticks ahead
+    long            local_input_end;
+    long            remote_input_end;
+    // NOTE: remote inputs the ticks from remote_input_end on were run with
+    GameInput       predicted[ROLLBACK_INPUT_RING];
+    // NOTE: earliest tick run with a remote input that turned out to be
+    // wrong, -1 if there is none
+    long            mispredicted_tick;
+    // NOTE: newest tick whose state is final, every input before it is known
+    long            confirmed_tick;
+    // NOTE: local inputs the peer has received, from its packets
+    long            remote_ack;
+    // NOTE: as of the newest packet, both are late by the trip it took
+    long            remote_tick;
+    int             remote_advantage;
+    long            last_wait_tick;
+    TickHash        local_hashes[ROLLBACK_HASH_HISTORY];
+    TickHash        remote_hashes[ROLLBACK_HASH_HISTORY];
+    TickHash        newest_hash;
+    // NOTE: tick the match was decided at, -1 while it is played
+    long            finished_tick;
+    int             linger_packets;
+    bool            disconnected;
+    bool            warned_player;
+    uint64_t        last_received;
+    RollbackStats   stats;
+};
+
+RollbackOptions DefaultRollbackOptions(void) {
+    return (RollbackOptions){
+        .local_player = 0,
+        .max_depth = ROLLBACK_DEFAULT_DEPTH,
+        .input_delay = ROLLBACK_DEFAULT_INPUT_DELAY,
+        .max_ticks = 0,
+    };
+}
+
+static void PutU32(uint8_t *bytes, uint32_t value) {
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+    bytes[2] = (uint8_t)(value >> 16);
+    bytes[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t GetU32(const uint8_t *bytes) {
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8
+         | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+static void *GetPlayerSnapshot(
+    const RollbackSession *session, int player, long tick
+) {
+    return GetSnapshotSlot(&session->players[player].snapshots, tick);
+}
+
+/* The last known input held down, a reset is a single press and is not
+ * repeated */
+static GameInput PredictRemoteInput(const RollbackSession *session) {
+    if (session->remote_input_end == 0) {
+        return (GameInput){ 0 };
+    }
+
+    const RollbackPlayer *remote = &session->players[session->remote_player];
+    GameInput             input =
+        remote->inputs[(session->remote_input_end - 1) % ROLLBACK_INPUT_RING];
+
+    input.reset_ball = false;
+    return input;
+}
+
+/* Runs tick on the field of player and keeps the state it leaves behind */
+static void RunPlayerTick(RollbackSession *session, int player, long tick) {
+    RollbackPlayer *field = &session->players[player];
+    int             slot = tick % ROLLBACK_INPUT_RING;
+    GameInput       input = field->inputs[slot];
+
+    if (player == session->remote_player
+        && tick >= session->remote_input_end) {
+        session->predicted[slot] = PredictRemoteInput(session);
+        input = session->predicted[slot];
+    }
+
+    TickGame(&field->config, &input);
+    SaveSnapshot(
+        &field->config,
+        tick + 1,
+        GetPlayerSnapshot(session, player, tick + 1)
+    );
+}
+
+RollbackSession *CreateRollbackSession(
+    const Configuration   *config,
+    const RollbackOptions *options,
+    NetTransport          *transport
+) {
+    RollbackSession *session =
+        MemoryCalloc(MEMORY_GAME, 1, sizeof(RollbackSession));
+
+    session->options = *options;
+    session->transport = transport;
+    session->remote_player = 1 - options->local_player;
+    // NOTE: the delayed ticks at the start are played without input
+    session->local_input_end = options->input_delay;
+    session->mispredicted_tick = -1;
+    session->confirmed_tick = -1;
+    session->finished_tick = -1;
+    session->linger_packets = ROLLBACK_LINGER_PACKETS;
+    session->last_received = GetClockNanoseconds();
+    session->stats = (RollbackStats){
+        .desync_tick = -1,
+        .local_player = options->local_player,
+    };
+
+    for (int i = 0; i < ROLLBACK_HASH_HISTORY; i++) {
+        session->local_hashes[i].tick = -1;
+        session->remote_hashes[i].tick = -1;
+    }
+
+    for (int i = 0; i < ROLLBACK_PLAYER_COUNT; i++) {
+        RollbackPlayer *player = &session->players[i];
+
+        // NOTE: memcpy, the configuration has const members and cannot be
+        // assigned. Snapshots hold neither swarm balls nor scrolling rows
+        memcpy(&player->config, config, sizeof(Configuration));
+        player->config.physics = &ANALYTIC_PHYSICS;
+        player->config.ball_count = 0;
+        player->config.scroll_speed = 0.0;
+        player->config.scheduler = NULL;
+        player->config.recorder = NULL;
+        player->config.profiler = NULL;
+        player->config.telemetry = NULL;
+
+        InitGame(&player->config);
+
+        player->bricks_total = CountLiveBricks(&player->config.bricks);
+
+        // NOTE: a rollback goes back max_depth ticks at most, to a state
+        // saved before the tick ran
+        CreateSnapshotRing(
+            &player->snapshots, &player->config, options->max_depth + 1
+        );
+        SaveSnapshot(
+            &player->config, 0, GetPlayerSnapshot(session, i, 0)
+        );
+    }
+
+    return session;
+}
+
+void DestroyRollbackSession(RollbackSession *session) {
+    for (int i = 0; i < ROLLBACK_PLAYER_COUNT; i++) {
+        FreeSnapshotRing(&session->players[i].snapshots);
+        ShutdownGame(&session->players[i].config);
+    }
+
+    MemoryFree(session);
+}
+
+static int GetHashIndex(long tick) {
+    return (int)(tick / ROLLBACK_HASH_INTERVAL % ROLLBACK_HASH_HISTORY);
+}
+
+static void CompareHashes(RollbackSession *session, long tick) {
+    int             index = GetHashIndex(tick);
+    const TickHash *local = &session->local_hashes[index];
+    const TickHash *remote = &session->remote_hashes[index];
+
+    if (local->tick != tick || remote->tick != tick) {
+        return;
+    }
+
+    session->stats.checked_hashes++;
+
+    if (local->hash != remote->hash && session->stats.desync_tick < 0) {
+        session->stats.desync_tick = tick;
+    }
+}
+
+static void ReceiveHash(RollbackSession *session, long tick, uint32_t hash) {
+    TickHash *remote = &session->remote_hashes[GetHashIndex(tick)];
+
+    // NOTE: the newest hash comes with every packet until the next one
+    if (tick % ROLLBACK_HASH_INTERVAL != 0 || remote->tick == tick) {
+        return;
+    }
+
+    *remote = (TickHash){ tick, hash };
+    CompareHashes(session, tick);
+}
+
+/* Ends the match at tick, the fields go back to their state at that tick in
+ * case they ran ahead of it */
+static void FinishMatch(RollbackSession *session, long tick) {
+    session->finished_tick = tick;
+
+    for (int i = 0; i < ROLLBACK_PLAYER_COUNT; i++) {
+        RollbackPlayer *player = &session->players[i];
+        const void     *snapshot = GetPlayerSnapshot(session, i, tick);
+
+        RestoreSnapshot(&player->config, snapshot);
+        session->stats.scores[i] =
+            player->bricks_total - CountSnapshotBricks(snapshot);
+    }
+
+    session->tick = tick;
+}
+
+/* Hashes the ticks whose inputs have all come in since the last call and
+ * checks them for the end of the match */
+static void ConfirmTicks(RollbackSession *session) {
+    long confirmed = session->remote_input_end < session->tick
+                       ? session->remote_input_end
+                       : session->tick;
+
+    while (session->confirmed_tick < confirmed
+           && session->finished_tick < 0) {
+        long        tick = ++session->confirmed_tick;
+        const void *first = GetPlayerSnapshot(session, 0, tick);
+        const void *second = GetPlayerSnapshot(session, 1, tick);
+
+        if (tick % ROLLBACK_HASH_INTERVAL == 0) {
+            // NOTE: in player order, the same on both peers
+            uint32_t hash =
+                HashSnapshot(first) * 16777619u ^ HashSnapshot(second);
+
+            session->newest_hash = (TickHash){ tick, hash };
+            session->local_hashes[GetHashIndex(tick)] = session->newest_hash;
+            CompareHashes(session, tick);
+        }
+
+        if ((session->options.max_ticks > 0
+             && tick >= session->options.max_ticks)
+            || CountSnapshotBricks(first) == 0
+            || CountSnapshotBricks(second) == 0) {
+            FinishMatch(session, tick);
+        }
+    }
+}
+
+void AddRemoteInput(RollbackSession *session, long tick, GameInput input) {
+    // NOTE: inputs far ahead would overwrite ones still needed, the peer
+    // sends them again later
+    if (tick != session->remote_input_end
+        || tick >= session->tick + ROLLBACK_INPUT_RING / 2) {
+        return;
+    }
+
+    int slot = tick % ROLLBACK_INPUT_RING;
+
+    session->players[session->remote_player].inputs[slot] = input;
+    session->remote_input_end++;
+
+    // NOTE: inputs arrive in tick order, the first wrong one is the earliest
+    if (tick < session->tick && session->mispredicted_tick < 0
+        && EncodeReplayInput(&input)
+               != EncodeReplayInput(&session->predicted[slot])) {
+        session->mispredicted_tick = tick;
+    }
+}
+
+static void ReceivePackets(RollbackSession *session) {
+    uint8_t packet[NET_MAX_PACKET_SIZE];
+    int     size;
+
+    while ((size = ReceiveNetPacket(
+                session->transport, packet, sizeof(packet)
+            ))
+           > 0) {
+        if (size < ROLLBACK_PACKET_HEADER_SIZE
+            || memcmp(packet, ROLLBACK_PACKET_MAGIC, 4) != 0) {
+            continue;
+        }
+
+        if (packet[4] != session->remote_player) {
+            if (!session->warned_player) {
+                fprintf(
+                    stderr,
+                    "The peer plays as player %d too, ignoring it\n",
+                    packet[4] + 1
+                );
+                session->warned_player = true;
+            }
+            continue;
+        }
+
+        int count = packet[13];
+
+        if (size < ROLLBACK_PACKET_HEADER_SIZE + count) {
+            continue;
+        }
+
+        session->last_received = GetClockNanoseconds();
+
+        long ack = GetU32(packet + 5);
+        long first = GetU32(packet + 9);
+
+        if (ack > session->remote_ack) {
+            session->remote_ack = ack;
+        }
+
+        session->remote_tick = GetU32(packet + 22);
+        session->remote_advantage = (int8_t)packet[26];
+
+        for (int i = 0; i < count; i++) {
+            AddRemoteInput(
+                session,
+                first + i,
+                DecodeReplayInput(packet[ROLLBACK_PACKET_HEADER_SIZE + i])
+            );
+        }
+
+        ReceiveHash(session, GetU32(packet + 14), GetU32(packet + 18));
+    }
+}
+
+/* Ticks run ahead of the peer as seen from here, clamped to a byte */
+static int GetLocalAdvantage(const RollbackSession *session) {
+    long advantage = session->tick - session->remote_tick;
+
+    return advantage > INT8_MAX   ? INT8_MAX
+         : advantage < INT8_MIN ? INT8_MIN
+                                : (int)advantage;
+}
+
+/*
+ * Both advantages include the time the ticks took to arrive, half their
+ * difference is how far this peer runs ahead. A peer ahead would predict
+ * every remote input and roll back the most while the other one never does,
+ * holding back a call now and then evens it out.
+ */
+static bool ShouldWaitForPeer(const RollbackSession *session) {
+    int ahead = (GetLocalAdvantage(session) - session->remote_advantage) / 2;
+
+    return session->transport && ahead >= 1
+        && session->tick - session->last_wait_tick >= ROLLBACK_SYNC_INTERVAL;
+}
+
+static void SendInputs(RollbackSession *session) {
+    uint8_t               packet[ROLLBACK_PACKET_HEADER_SIZE
+                                 + ROLLBACK_MAX_PACKET_INPUTS];
+    const RollbackPlayer *local =
+        &session->players[session->options.local_player];
+
+    // NOTE: inputs older than half the ring are long acknowledged, the ack
+    // that says so was lost
+    long first = session->remote_ack;
+
+    if (first < session->local_input_end - ROLLBACK_INPUT_RING / 2) {
+        first = session->local_input_end - ROLLBACK_INPUT_RING / 2;
+    }
+
+    long count = session->local_input_end - first;
+
+    if (count > ROLLBACK_MAX_PACKET_INPUTS) {
+        count = ROLLBACK_MAX_PACKET_INPUTS;
+    }
+
+    memcpy(packet, ROLLBACK_PACKET_MAGIC, 4);
+    packet[4] = (uint8_t)session->options.local_player;
+    PutU32(packet + 5, (uint32_t)session->remote_input_end);
+    PutU32(packet + 9, (uint32_t)first);
+    packet[13] = (uint8_t)count;
+    PutU32(packet + 14, (uint32_t)session->newest_hash.tick);
+    PutU32(packet + 18, session->newest_hash.hash);
+    PutU32(packet + 22, (uint32_t)session->tick);
+    packet[26] = (uint8_t)(int8_t)GetLocalAdvantage(session);
+
+    for (long i = 0; i < count; i++) {
+        packet[ROLLBACK_PACKET_HEADER_SIZE + i] = EncodeReplayInput(
+            &local->inputs[(first + i) % ROLLBACK_INPUT_RING]
+        );
+    }
+
+    SendNetPacket(
+        session->transport, packet, ROLLBACK_PACKET_HEADER_SIZE + (int)count
+    );
+
+    if (session->finished_tick >= 0
+        && session->remote_ack >= session->finished_tick) {
+        session->linger_packets--;
+    }
+}
+
+static void RollBack(RollbackSession *session) {
+    long            from = session->mispredicted_tick;
+    RollbackPlayer *remote = &session->players[session->remote_player];
+    uint64_t        start = GetClockNanoseconds();
+
+    // NOTE: the fields do not interact and the local input is never
+    // predicted, the remote field is the only one to go back
+    RestoreSnapshot(
+        &remote->config,
+        GetPlayerSnapshot(session, session->remote_player, from)
+    );
+
+    for (long tick = from; tick < session->tick; tick++) {
+        RunPlayerTick(session, session->remote_player, tick);
+    }
+
+    double milliseconds = (GetClockNanoseconds() - start) * 1e-6;
+    int    depth = (int)(session->tick - from);
+
+    session->stats.rollbacks++;
+    session->stats.resimulated_ticks += depth;
+    session->stats.rollback_milliseconds += milliseconds;
+
+    if (depth > session->stats.max_depth) {
+        session->stats.max_depth = depth;
+    }
+
+    if (milliseconds > session->stats.max_rollback_milliseconds) {
+        session->stats.max_rollback_milliseconds = milliseconds;
+    }
+
+    session->mispredicted_tick = -1;
+}
+
+bool IsRollbackOver(const RollbackSession *session) {
+    if (session->disconnected) {
+        return true;
+    }
+
+    return session->finished_tick >= 0
+        && (!session->transport || session->linger_packets <= 0);
+}
+
+bool AdvanceRollback(RollbackSession *session, const GameInput *local_input) {
+    if (IsRollbackOver(session)) {
+        return false;
+    }
+
+    if (session->transport) {
+        ReceivePackets(session);
+
+        if (GetClockNanoseconds() - session->last_received
+            > ROLLBACK_TIMEOUT_SECONDS * 1e9) {
+            fprintf(stderr, "The peer stopped answering\n");
+            session->disconnected = true;
+            return false;
+        }
+    }
+
+    if (session->mispredicted_tick >= 0) {
+        RollBack(session);
+    }
+
+    ConfirmTicks(session);
+
+    // NOTE: at the tick limit the session only waits for the inputs that
+    // confirm the end
+    bool waiting = session->finished_tick >= 0
+                || (session->options.max_ticks > 0
+                    && session->tick >= session->options.max_ticks);
+    bool stalled = !waiting
+                && session->tick - session->remote_input_end
+                       >= session->options.max_depth;
+    bool synced = !waiting && !stalled && ShouldWaitForPeer(session);
+    bool ran = !waiting && !stalled && !synced;
+
+    if (stalled) {
+        session->stats.stalls++;
+    }
+
+    if (synced) {
+        session->stats.sync_waits++;
+        session->last_wait_tick = session->tick;
+    }
+
+    if (ran) {
+        RollbackPlayer *local =
+            &session->players[session->options.local_player];
+
+        local->inputs[session->local_input_end % ROLLBACK_INPUT_RING] =
+            *local_input;
+        session->local_input_end++;
+
+        for (int i = 0; i < ROLLBACK_PLAYER_COUNT; i++) {
+            RunPlayerTick(session, i, session->tick);
+        }
+
+        session->tick++;
+        ConfirmTicks(session);
+    }
+
+    if (session->transport) {
+        SendInputs(session);
+    }
+
+    return ran;
+}
+
+long GetRollbackTick(const RollbackSession *session) {
+    return session->tick;
+}
+
+Configuration *GetRollbackConfiguration(
+    RollbackSession *session, int player
+) {
+    return &session->players[player].config;
+}
+
+int GetRollbackScore(const RollbackSession *session, int player) {
+    const RollbackPlayer *field = &session->players[player];
+
+    return field->bricks_total - CountLiveBricks(&field->config.bricks);
+}
+
+RollbackStats GetRollbackStats(const RollbackSession *session) {
+    RollbackStats stats = session->stats;
+    int           local = session->options.local_player;
+
+    stats.ticks = session->confirmed_tick > 0 ? session->confirmed_tick : 0;
+
+    if (session->finished_tick >= 0) {
+        int difference =
+            stats.scores[local] - stats.scores[session->remote_player];
+
+        stats.outcome = difference > 0   ? ROLLBACK_WON
+                      : difference < 0 ? ROLLBACK_LOST
+                                       : ROLLBACK_DRAW;
+    } else {
+        for (int i = 0; i < ROLLBACK_PLAYER_COUNT; i++) {
+            stats.scores[i] = GetRollbackScore(session, i);
+        }
+
+        stats.outcome = session->disconnected ? ROLLBACK_DISCONNECTED
+                                              : ROLLBACK_PLAYING;
+    }
+
+    if (session->transport) {
+        stats.net = GetNetStats(session->transport);
+    }
+
+    return stats;
+}
+
+const char *GetRollbackOutcomeName(RollbackOutcome outcome) {
+    static const char *names[] = {
+        [ROLLBACK_PLAYING] = "playing",
+        [ROLLBACK_WON] = "won",
+        [ROLLBACK_LOST] = "lost",
+        [ROLLBACK_DRAW] = "draw",
+        [ROLLBACK_DISCONNECTED] = "disconnected",
+    };
+
+    return names[outcome];
+}
+
+void PrintRollbackStats(const RollbackStats *stats) {
+    int local = stats->local_player;
+
+    printf("Player:           %d\n", local + 1);
+    printf("Outcome:          %s\n", GetRollbackOutcomeName(stats->outcome));
+    printf(
+        "Score:            %d : %d\n",
+        stats->scores[local],
+        stats->scores[1 - local]
+    );
+    printf("Ticks:            %ld\n", stats->ticks);
+    printf("Stalls:           %ld\n", stats->stalls);
+    printf("Sync waits:       %ld\n", stats->sync_waits);
+    printf("Rollbacks:        %ld\n", stats->rollbacks);
+    printf(
+        "Avg depth:        %.2f ticks\n",
+        stats->rollbacks > 0
+            ? (double)stats->resimulated_ticks / stats->rollbacks
+            : 0.0
+    );
+    printf("Max depth:        %d ticks\n", stats->max_depth);
+    printf(
+        "Avg rollback:     %.4f ms\n",
+        stats->rollbacks > 0
+            ? stats->rollback_milliseconds / stats->rollbacks
+            : 0.0
+    );
+    printf("Max rollback:     %.4f ms\n", stats->max_rollback_milliseconds);
+    printf("Packets sent:     %ld\n", stats->net.sent);
+    printf("Packets dropped:  %ld\n", stats->net.dropped);
+    printf("Packets received: %ld\n", stats->net.received);
+    printf("Hashes checked:   %ld\n", stats->checked_hashes);
+
+    if (stats->desync_tick >= 0) {
+        printf("Desync at tick:   %ld\n", stats->desync_tick);
+    } else {
+        printf("Desync at tick:   none\n");
+    }
+}
@@ -0,0 +1,183 @@
+#include <breakout/snapshot.h>
+#include <string.h>
+
+size_t GetSnapshotSize(const Configuration *config) {
+    return sizeof(GameSnapshot)
+         + sizeof(uint64_t) * config->bricks.word_count
+         + sizeof(uint8_t) * config->bricks.count;
+}
+
+void SaveSnapshot(const Configuration *config, long tick, void *buffer) {
+    GameSnapshot *snapshot = buffer;
+
+    *snapshot = (GameSnapshot){
+        .size = (uint32_t)GetSnapshotSize(config),
+        .brick_count = (uint32_t)config->bricks.count,
+        .tick = tick,
+        .bricks_in_row = config->bricks_in_row,
+        .tick_rate = config->tick_rate,
+        .max_frame_ticks = config->max_frame_ticks,
+        .brick_width = config->brick_width,
+        .brick_height = config->brick_height,
+        .player_movement_speed = config->player.movement_speed,
+        .player_width = config->player.width,
+        .player_height = config->player.height,
+        .ball_radius = config->ball.radius,
+        .ball_max_speed = config->ball.max_speed,
+        .ball_min_speed_multiplier = config->ball.min_speed_multiplier,
+        .ball_initial_velocity = config->ball.initial_velocity,
+        .ball_position = GetBallPosition(config),
+        .ball_velocity = GetBallVelocity(config),
+        .ball_previous_position = config->ball.previous_position,
+        .player_position = GetPlayerPosition(config),
+        .player_velocity = config->physics->get_player_velocity(config),
+        .player_previous_position = config->player.previous_position,
+    };
+
+    uint64_t *live = (uint64_t *)(snapshot + 1);
+
+    memcpy(
+        live, config->bricks.live, sizeof(uint64_t) * config->bricks.word_count
+    );
+    memcpy(
+        live + config->bricks.word_count,
+        config->bricks.hit_points,
+        sizeof(uint8_t) * config->bricks.count
+    );
+}
+
+bool RestoreSnapshot(Configuration *config, const void *buffer) {
+    const GameSnapshot *snapshot = buffer;
+    BrickStore         *bricks = &config->bricks;
+
+    if (snapshot->brick_count != (uint32_t)bricks->count
+        || snapshot->bricks_in_row != config->bricks_in_row
+        || snapshot->brick_width != config->brick_width
+        || snapshot->brick_height != config->brick_height) {
+        return false;
+    }
+
+    // NOTE: the shapes keep their sizes, a snapshot from before a reload that
+    // resized them would leave the colliders out of sync with the config
+    if (snapshot->player_width != config->player.width
+        || snapshot->player_height != config->player.height
+        || snapshot->ball_radius != config->ball.radius) {
+        return false;
+    }
+
+    config->tick_rate = snapshot->tick_rate;
+    config->max_frame_ticks = snapshot->max_frame_ticks;
+    config->player.movement_speed = snapshot->player_movement_speed;
+    config->ball.max_speed = snapshot->ball_max_speed;
+    config->ball.min_speed_multiplier = snapshot->ball_min_speed_multiplier;
+    config->ball.initial_velocity = snapshot->ball_initial_velocity;
+
+    config->physics->set_ball_position(config, snapshot->ball_position);
+    config->physics->set_ball_velocity(config, snapshot->ball_velocity);
+    config->ball.previous_position = snapshot->ball_previous_position;
+
+    config->physics->set_player_position(config, snapshot->player_position);
+    config->physics->set_player_velocity(config, snapshot->player_velocity);
+    config->player.previous_position = snapshot->player_previous_position;
+
+    const uint64_t *live = (const uint64_t *)(snapshot + 1);
+
+    for (int word = 0; word < bricks->word_count; word++) {
+        uint64_t changed = bricks->live[word] ^ live[word];
+
+        while (changed) {
+            int bit = 0;
+
+            while (!((changed >> bit) & 1)) {
+                bit++;
+            }
+            changed &= changed - 1;
+
+            int brick_index = word * BRICK_STORE_WORD_BITS + bit;
+
+            if ((live[word] >> bit) & 1) {
+                SpawnBrick(config, brick_index);
+                RestoreBrickInGrid(
+                    &config->brick_grid,
+                    bricks->positions[brick_index],
+                    bricks->sizes[brick_index]
+                );
+            } else {
+                DestroyBrick(config, brick_index);
+            }
+        }
+    }
+
+    memcpy(
+        bricks->hit_points,
+        live + bricks->word_count,
+        sizeof(uint8_t) * bricks->count
+    );
+    return true;
+}
+
+int CountSnapshotBricks(const void *buffer) {
+    const GameSnapshot *snapshot = buffer;
+    BrickStore          bricks = {
+        .count = (int)snapshot->brick_count,
+        .word_count = ((int)snapshot->brick_count + BRICK_STORE_WORD_BITS - 1)
+                    / BRICK_STORE_WORD_BITS,
+        .live = (uint64_t *)(snapshot + 1),
+    };
+
+    return CountLiveBricks(&bricks);
+}
+
+void CreateSnapshotRing(
+    SnapshotRing *ring, const Configuration *config, int capacity
+) {
+    // NOTE: keep every slot 8 byte aligned for the bitset that follows
+    size_t slot_size = (GetSnapshotSize(config) + 7) & ~(size_t)7;
+
+    *ring = (SnapshotRing){
+        .buffer = MemoryAlloc(MEMORY_GAME, slot_size * capacity),
+        .slot_size = slot_size,
+        .capacity = capacity,
+    };
+}
+
+void FreeSnapshotRing(SnapshotRing *ring) {
+    MemoryFree(ring->buffer);
+    *ring = (SnapshotRing){ 0 };
+}
+
+void PushSnapshot(SnapshotRing *ring, const Configuration *config, long tick) {
+    SaveSnapshot(config, tick, ring->buffer + ring->head * ring->slot_size);
+
+    ring->head = (ring->head + 1) % ring->capacity;
+
+    if (ring->count < ring->capacity) {
+        ring->count++;
+    }
+}
+
+void *GetSnapshotSlot(const SnapshotRing *ring, long tick) {
+    return ring->buffer + (tick % ring->capacity) * ring->slot_size;
+}
+
+bool PopSnapshot(SnapshotRing *ring, Configuration *config, long *tick) {
+    if (ring->count == 0) {
+        return false;
+    }
+
+    int newest = (ring->head + ring->capacity - 1) % ring->capacity;
+    const GameSnapshot *snapshot =
+        (const GameSnapshot *)(ring->buffer + newest * ring->slot_size);
+
+    if (!RestoreSnapshot(config, snapshot)) {
+        return false;
+    }
+
+    if (tick) {
+        *tick = snapshot->tick;
+    }
+
+    ring->head = newest;
+    ring->count--;
+    return true;
+}
@@ -0,0 +1,61 @@
+#include <breakout/spsc_ring.h>
+#include <breakout/allocator.h>
+#include <string.h>
+
+void CreateSpscRing(SpscRing *ring, size_t item_size, uint32_t capacity) {
+    uint32_t rounded = 1;
+
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+
+    ring->items = MemoryAlloc(MEMORY_GAME, item_size * rounded);
+    ring->item_size = item_size;
+    ring->mask = rounded - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+}
+
+void FreeSpscRing(SpscRing *ring) {
+    MemoryFree(ring->items);
+    ring->items = NULL;
+}
+
+bool PushSpscRing(SpscRing *ring, const void *item) {
+    uint_fast32_t tail =
+        atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint_fast32_t head =
+        atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    // NOTE: indices run freely and wrap, only their difference matters
+    if ((uint32_t)(tail - head) > ring->mask) {
+        return false;
+    }
+
+    memcpy(
+        ring->items + (tail & ring->mask) * ring->item_size,
+        item,
+        ring->item_size
+    );
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool PopSpscRing(SpscRing *ring, void *item) {
+    uint_fast32_t head =
+        atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint_fast32_t tail =
+        atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head == tail) {
+        return false;
+    }
+
+    memcpy(
+        item,
+        ring->items + (head & ring->mask) * ring->item_size,
+        ring->item_size
+    );
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
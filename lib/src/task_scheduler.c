@@ -0,0 +1,332 @@
+#include <breakout/task_scheduler.h>
+#include <breakout/allocator.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <threads.h>
+
+// NOTE: how many ranges a task is cut into per worker, more ranges balance
+// better at the cost of queue traffic
+#define RANGES_PER_WORKER 4
+
+typedef struct Task {
+    TaskFunction *function;
+    void         *context;
+    atomic_int    remaining;
+    atomic_bool   in_use;
+} Task;
+
+typedef struct WorkItem {
+    Task *task;
+    int   start_index;
+    int   end_index;
+} WorkItem;
+
+/* Owner pushes and pops at the bottom, thieves take from the top */
+typedef struct WorkQueue {
+    mtx_t    mutex;
+    int      top;
+    int      bottom;
+    WorkItem items[TASK_QUEUE_CAPACITY];
+} WorkQueue;
+
+typedef struct Worker {
+    TaskScheduler *scheduler;
+    thrd_t         thread;
+    int            index;
+} Worker;
+
+struct TaskScheduler {
+    int         worker_count;
+    atomic_bool shutdown;
+    atomic_int  pending;
+    atomic_int  next_queue;
+    mtx_t       sleep_mutex;
+    cnd_t       wake;
+    Worker      workers[TASK_SCHEDULER_MAX_WORKERS];
+    WorkQueue   queues[TASK_SCHEDULER_MAX_WORKERS];
+    Task        tasks[TASK_SCHEDULER_MAX_TASKS];
+};
+
+static bool PushWork(WorkQueue *queue, WorkItem item) {
+    mtx_lock(&queue->mutex);
+
+    if (queue->bottom - queue->top == TASK_QUEUE_CAPACITY) {
+        mtx_unlock(&queue->mutex);
+        return false;
+    }
+
+    queue->items[queue->bottom % TASK_QUEUE_CAPACITY] = item;
+    queue->bottom++;
+
+    mtx_unlock(&queue->mutex);
+    return true;
+}
+
+static bool PopWork(WorkQueue *queue, WorkItem *item) {
+    mtx_lock(&queue->mutex);
+
+    if (queue->bottom == queue->top) {
+        mtx_unlock(&queue->mutex);
+        return false;
+    }
+
+    queue->bottom--;
+    *item = queue->items[queue->bottom % TASK_QUEUE_CAPACITY];
+
+    mtx_unlock(&queue->mutex);
+    return true;
+}
+
+static bool StealWork(WorkQueue *queue, WorkItem *item) {
+    mtx_lock(&queue->mutex);
+
+    if (queue->bottom == queue->top) {
+        mtx_unlock(&queue->mutex);
+        return false;
+    }
+
+    *item = queue->items[queue->top % TASK_QUEUE_CAPACITY];
+    queue->top++;
+
+    mtx_unlock(&queue->mutex);
+    return true;
+}
+
+static bool TakeWork(TaskScheduler *scheduler, int worker_index, WorkItem *item) {
+    if (PopWork(&scheduler->queues[worker_index], item)) {
+        atomic_fetch_sub(&scheduler->pending, 1);
+        return true;
+    }
+
+    for (int i = 1; i < scheduler->worker_count; i++) {
+        int victim = (worker_index + i) % scheduler->worker_count;
+
+        if (StealWork(&scheduler->queues[victim], item)) {
+            atomic_fetch_sub(&scheduler->pending, 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void ExecuteWork(const WorkItem *item, int worker_index) {
+    item->task->function(
+        item->start_index,
+        item->end_index,
+        (uint32_t)worker_index,
+        item->task->context
+    );
+    atomic_fetch_sub(&item->task->remaining, 1);
+}
+
+static int WorkerMain(void *argument) {
+    Worker        *worker = argument;
+    TaskScheduler *scheduler = worker->scheduler;
+
+    while (!atomic_load(&scheduler->shutdown)) {
+        WorkItem item;
+
+        if (TakeWork(scheduler, worker->index, &item)) {
+            ExecuteWork(&item, worker->index);
+            continue;
+        }
+
+        mtx_lock(&scheduler->sleep_mutex);
+        while (atomic_load(&scheduler->pending) == 0
+               && !atomic_load(&scheduler->shutdown)) {
+            cnd_wait(&scheduler->wake, &scheduler->sleep_mutex);
+        }
+        mtx_unlock(&scheduler->sleep_mutex);
+    }
+
+    return 0;
+}
+
+TaskScheduler *CreateTaskScheduler(int worker_count) {
+    if (worker_count < 1) {
+        worker_count = 1;
+    }
+    if (worker_count > TASK_SCHEDULER_MAX_WORKERS) {
+        worker_count = TASK_SCHEDULER_MAX_WORKERS;
+    }
+
+    TaskScheduler *scheduler =
+        MemoryCalloc(MEMORY_GAME, 1, sizeof(TaskScheduler));
+    scheduler->worker_count = worker_count;
+
+    atomic_init(&scheduler->shutdown, false);
+    atomic_init(&scheduler->pending, 0);
+    atomic_init(&scheduler->next_queue, 0);
+    mtx_init(&scheduler->sleep_mutex, mtx_plain);
+    cnd_init(&scheduler->wake);
+
+    for (int i = 0; i < TASK_SCHEDULER_MAX_TASKS; i++) {
+        atomic_init(&scheduler->tasks[i].remaining, 0);
+        atomic_init(&scheduler->tasks[i].in_use, false);
+    }
+
+    for (int i = 0; i < worker_count; i++) {
+        mtx_init(&scheduler->queues[i].mutex, mtx_plain);
+    }
+
+    // NOTE: worker 0 is whoever calls FinishTask, only the rest get threads
+    for (int i = 1; i < worker_count; i++) {
+        Worker *worker = &scheduler->workers[i];
+        worker->scheduler = scheduler;
+        worker->index = i;
+        thrd_create(&worker->thread, WorkerMain, worker);
+    }
+
+    return scheduler;
+}
+
+void DestroyTaskScheduler(TaskScheduler *scheduler) {
+    mtx_lock(&scheduler->sleep_mutex);
+    atomic_store(&scheduler->shutdown, true);
+    cnd_broadcast(&scheduler->wake);
+    mtx_unlock(&scheduler->sleep_mutex);
+
+    for (int i = 1; i < scheduler->worker_count; i++) {
+        thrd_join(scheduler->workers[i].thread, NULL);
+    }
+
+    for (int i = 0; i < scheduler->worker_count; i++) {
+        mtx_destroy(&scheduler->queues[i].mutex);
+    }
+
+    cnd_destroy(&scheduler->wake);
+    mtx_destroy(&scheduler->sleep_mutex);
+    MemoryFree(scheduler);
+}
+
+int GetTaskSchedulerWorkerCount(const TaskScheduler *scheduler) {
+    return scheduler->worker_count;
+}
+
+static Task *AcquireTask(TaskScheduler *scheduler) {
+    for (int i = 0; i < TASK_SCHEDULER_MAX_TASKS; i++) {
+        bool expected = false;
+
+        if (atomic_compare_exchange_strong(
+                &scheduler->tasks[i].in_use, &expected, true
+            )) {
+            return &scheduler->tasks[i];
+        }
+    }
+
+    return NULL;
+}
+
+void *EnqueueTask(
+    TaskScheduler *scheduler,
+    TaskFunction  *function,
+    int            item_count,
+    int            min_range,
+    void          *context
+) {
+    if (min_range < 1) {
+        min_range = 1;
+    }
+
+    Task *task = NULL;
+
+    // NOTE: Box2D hands every solver worker over as a task of one item that
+    // only returns once the step is done, those have to be queued to run
+    // side by side instead of inline one after another
+    if (scheduler->worker_count > 1 && item_count > 0) {
+        task = AcquireTask(scheduler);
+    }
+
+    if (!task) {
+        function(0, item_count, 0, context);
+        return NULL;
+    }
+
+    int range_count = scheduler->worker_count * RANGES_PER_WORKER;
+
+    if (range_count > item_count / min_range) {
+        range_count = item_count / min_range;
+    }
+
+    if (range_count < 1) {
+        range_count = 1;
+    }
+
+    task->function = function;
+    task->context = context;
+    atomic_store(&task->remaining, range_count);
+
+    int queue_index = atomic_fetch_add(&scheduler->next_queue, 1);
+    int start_index = 0;
+
+    for (int i = 0; i < range_count; i++) {
+        // NOTE: spread the remainder so ranges differ by at most one item
+        int end_index = (int)((long long)item_count * (i + 1) / range_count);
+
+        WorkItem item = { task, start_index, end_index };
+        WorkQueue *queue =
+            &scheduler->queues[(queue_index + i) % scheduler->worker_count];
+
+        if (PushWork(queue, item)) {
+            atomic_fetch_add(&scheduler->pending, 1);
+        } else {
+            ExecuteWork(&item, 0);
+        }
+
+        start_index = end_index;
+    }
+
+    mtx_lock(&scheduler->sleep_mutex);
+    cnd_broadcast(&scheduler->wake);
+    mtx_unlock(&scheduler->sleep_mutex);
+
+    return task;
+}
+
+void FinishTask(TaskScheduler *scheduler, void *task) {
+    Task *finished = task;
+
+    if (!finished) {
+        return;
+    }
+
+    while (atomic_load(&finished->remaining) > 0) {
+        WorkItem item;
+
+        if (TakeWork(scheduler, 0, &item)) {
+            ExecuteWork(&item, 0);
+        } else {
+            thrd_yield();
+        }
+    }
+
+    atomic_store(&finished->in_use, false);
+}
+
+void RunParallel(
+    TaskScheduler *scheduler,
+    TaskFunction  *function,
+    int            item_count,
+    int            min_range,
+    void          *context
+) {
+    FinishTask(
+        scheduler,
+        EnqueueTask(scheduler, function, item_count, min_range, context)
+    );
+}
+
+void *EnqueueBox2DTask(
+    TaskFunction *task,
+    int           item_count,
+    int           min_range,
+    void         *task_context,
+    void         *user_context
+) {
+    return EnqueueTask(user_context, task, item_count, min_range, task_context);
+}
+
+void FinishBox2DTask(void *user_task, void *user_context) {
+    FinishTask(user_context, user_task);
+}
@@ -0,0 +1,348 @@
+#include <breakout/telemetry.h>
+#include <breakout/allocator.h>
+#include <breakout/spsc_ring.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <threads.h>
+
+// NOTE: how long the writer sleeps between drains
+#define TELEMETRY_WRITER_INTERVAL_MILLISECONDS 5
+
+static const char *EVENT_NAMES[TELEMETRY_EVENT_TYPE_COUNT] = {
+    "brick_destroyed", "paddle_hit",    "ball_lost",
+    "speed_clamped",   "speed_boosted", "events_dropped",
+};
+
+struct Telemetry {
+    SpscRing             events;
+    thrd_t               thread;
+    atomic_bool          stop;
+    // NOTE: producer side, only the game loop touches these two
+    uint32_t             tick;
+    atomic_uint_fast32_t dropped;
+    // NOTE: writer side
+    FILE                *file;
+    uint32_t             last_tick;
+    uint32_t             logged_dropped;
+};
+
+static void WriteU32(FILE *file, uint32_t value) {
+    uint8_t bytes[4] = { value, value >> 8, value >> 16, value >> 24 };
+    fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+static void WriteF32(FILE *file, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteU32(file, bits);
+}
+
+static void WriteVarint(FILE *file, uint32_t value) {
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7f) | 0x80, file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
+
+static bool ReadU32(FILE *file, uint32_t *value) {
+    uint8_t bytes[4];
+
+    if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) {
+        return false;
+    }
+
+    *value = (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8
+           | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+    return true;
+}
+
+static bool ReadF32(FILE *file, float *value) {
+    uint32_t bits;
+
+    if (!ReadU32(file, &bits)) {
+        return false;
+    }
+
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+}
+
+static bool ReadVarint(FILE *file, uint32_t *value) {
+    *value = 0;
+
+    for (int shift = 0; shift < 35; shift += 7) {
+        int byte = fgetc(file);
+
+        if (byte == EOF) {
+            return false;
+        }
+
+        *value |= (uint32_t)(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void WriteEvent(Telemetry *telemetry, const TelemetryEvent *event) {
+    FILE *file = telemetry->file;
+
+    fputc(event->type, file);
+    WriteVarint(file, event->tick - telemetry->last_tick);
+    telemetry->last_tick = event->tick;
+
+    switch (event->type) {
+    case TELEMETRY_BRICK_DESTROYED:
+        WriteVarint(file, (uint32_t)event->brick_index);
+        break;
+    case TELEMETRY_PADDLE_HIT:
+    case TELEMETRY_BALL_LOST:
+        WriteF32(file, event->offset);
+        WriteF32(file, event->speed);
+        break;
+    case TELEMETRY_SPEED_CLAMPED:
+    case TELEMETRY_SPEED_BOOSTED:
+        WriteF32(file, event->speed);
+        WriteF32(file, event->corrected_speed);
+        break;
+    case TELEMETRY_EVENTS_DROPPED:
+        WriteVarint(file, event->dropped_count);
+        break;
+    }
+}
+
+/* Logs the events dropped since the last drain, at the tick of the last
+ * event written */
+static void WriteDroppedEvents(Telemetry *telemetry) {
+    uint32_t dropped = (uint32_t)atomic_load_explicit(
+        &telemetry->dropped, memory_order_relaxed
+    );
+
+    if (dropped == telemetry->logged_dropped) {
+        return;
+    }
+
+    TelemetryEvent event = {
+        .tick = telemetry->last_tick,
+        .type = TELEMETRY_EVENTS_DROPPED,
+        .dropped_count = dropped - telemetry->logged_dropped,
+    };
+
+    WriteEvent(telemetry, &event);
+    telemetry->logged_dropped = dropped;
+}
+
+static int TelemetryWriterMain(void *argument) {
+    Telemetry     *telemetry = argument;
+    TelemetryEvent event;
+
+    for (;;) {
+        // NOTE: read before draining, everything pushed before the stop is
+        // then written by this last drain
+        bool stopping = atomic_load(&telemetry->stop);
+
+        while (PopSpscRing(&telemetry->events, &event)) {
+            WriteEvent(telemetry, &event);
+        }
+
+        WriteDroppedEvents(telemetry);
+
+        if (stopping) {
+            return 0;
+        }
+
+        struct timespec interval = {
+            .tv_nsec = TELEMETRY_WRITER_INTERVAL_MILLISECONDS * 1000000L,
+        };
+        thrd_sleep(&interval, NULL);
+    }
+}
+
+Telemetry *StartTelemetry(const char *path, long tick_rate) {
+    FILE *file = fopen(path, "wb");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open telemetry log \"%s\"\n", path);
+        return NULL;
+    }
+
+    fwrite(TELEMETRY_MAGIC, 1, 4, file);
+    WriteU32(file, TELEMETRY_VERSION);
+    WriteU32(file, (uint32_t)tick_rate);
+
+    Telemetry *telemetry = MemoryCalloc(MEMORY_GAME, 1, sizeof(Telemetry));
+    telemetry->file = file;
+    CreateSpscRing(
+        &telemetry->events, sizeof(TelemetryEvent), TELEMETRY_RING_CAPACITY
+    );
+    atomic_init(&telemetry->stop, false);
+    atomic_init(&telemetry->dropped, 0);
+
+    if (thrd_create(&telemetry->thread, TelemetryWriterMain, telemetry)
+        != thrd_success) {
+        fprintf(stderr, "Failed to start the telemetry writer\n");
+        FreeSpscRing(&telemetry->events);
+        MemoryFree(telemetry);
+        fclose(file);
+        return NULL;
+    }
+
+    return telemetry;
+}
+
+void StopTelemetry(Telemetry *telemetry) {
+    if (!telemetry) {
+        return;
+    }
+
+    atomic_store(&telemetry->stop, true);
+    thrd_join(telemetry->thread, NULL);
+
+    if (ferror(telemetry->file)) {
+        fprintf(stderr, "Failed to write the telemetry log\n");
+    }
+
+    fclose(telemetry->file);
+    FreeSpscRing(&telemetry->events);
+    MemoryFree(telemetry);
+}
+
+void RecordTelemetryEvent(Telemetry *telemetry, TelemetryEvent event) {
+    if (!telemetry) {
+        return;
+    }
+
+    event.tick = telemetry->tick;
+
+    if (!PushSpscRing(&telemetry->events, &event)) {
+        atomic_fetch_add_explicit(
+            &telemetry->dropped, 1, memory_order_relaxed
+        );
+    }
+}
+
+void AdvanceTelemetryTick(Telemetry *telemetry) {
+    if (telemetry) {
+        telemetry->tick++;
+    }
+}
+
+static bool ReadEvent(FILE *file, TelemetryEvent *event, uint32_t *tick) {
+    uint32_t ticks, value;
+
+    if (!ReadVarint(file, &ticks)) {
+        return false;
+    }
+
+    *tick += ticks;
+    event->tick = *tick;
+
+    switch (event->type) {
+    case TELEMETRY_BRICK_DESTROYED:
+        if (!ReadVarint(file, &value)) {
+            return false;
+        }
+        event->brick_index = (int32_t)value;
+        return true;
+    case TELEMETRY_PADDLE_HIT:
+    case TELEMETRY_BALL_LOST:
+        return ReadF32(file, &event->offset) && ReadF32(file, &event->speed);
+    case TELEMETRY_SPEED_CLAMPED:
+    case TELEMETRY_SPEED_BOOSTED:
+        return ReadF32(file, &event->speed)
+            && ReadF32(file, &event->corrected_speed);
+    case TELEMETRY_EVENTS_DROPPED:
+        return ReadVarint(file, &event->dropped_count);
+    }
+
+    return false;
+}
+
+static void WriteEventRow(
+    FILE *csv, const TelemetryEvent *event, uint32_t tick_rate
+) {
+    fprintf(
+        csv,
+        "%u,%.4f,%s,",
+        event->tick,
+        tick_rate ? (double)event->tick / tick_rate : 0.0,
+        EVENT_NAMES[event->type]
+    );
+
+    switch (event->type) {
+    case TELEMETRY_BRICK_DESTROYED:
+        fprintf(csv, "%d,,,,\n", event->brick_index);
+        break;
+    case TELEMETRY_PADDLE_HIT:
+    case TELEMETRY_BALL_LOST:
+        fprintf(csv, ",%.2f,%.3f,,\n", event->offset, event->speed);
+        break;
+    case TELEMETRY_SPEED_CLAMPED:
+    case TELEMETRY_SPEED_BOOSTED:
+        fprintf(csv, ",,%.3f,%.3f,\n", event->speed, event->corrected_speed);
+        break;
+    case TELEMETRY_EVENTS_DROPPED:
+        fprintf(csv, ",,,,%u\n", event->dropped_count);
+        break;
+    }
+}
+
+bool DecodeTelemetryLog(const char *path, FILE *csv, long *event_count) {
+    *event_count = 0;
+
+    FILE *file = fopen(path, "rb");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open telemetry log \"%s\"\n", path);
+        return false;
+    }
+
+    char     magic[4];
+    uint32_t version = 0;
+    uint32_t tick_rate = 0;
+
+    bool ok = fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+           && memcmp(magic, TELEMETRY_MAGIC, sizeof(magic)) == 0
+           && ReadU32(file, &version) && version == TELEMETRY_VERSION
+           && ReadU32(file, &tick_rate);
+
+    if (!ok) {
+        fprintf(stderr, "\"%s\" is not a telemetry log\n", path);
+        fclose(file);
+        return false;
+    }
+
+    fprintf(
+        csv, "tick,seconds,event,brick,offset,speed,corrected_speed,dropped\n"
+    );
+
+    uint32_t tick = 0;
+    int      type;
+
+    while ((type = fgetc(file)) != EOF) {
+        TelemetryEvent event = { .type = (uint8_t)type };
+
+        // NOTE: a log cut short by a crash ends in a partial record
+        if (type >= TELEMETRY_EVENT_TYPE_COUNT
+            || !ReadEvent(file, &event, &tick)) {
+            fprintf(
+                stderr,
+                "Telemetry log \"%s\" is damaged after %ld events\n",
+                path,
+                *event_count
+            );
+            ok = false;
+            break;
+        }
+
+        WriteEventRow(csv, &event, tick_rate);
+        (*event_count)++;
+    }
+
+    fclose(file);
+    return ok;
+}